@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "sim/engine.hh"
+#include "util/stopwatch.hh"
+
+// Engine microbenchmark
+// Keeps fixed number of pending events (hold model): each dispatched event
+// schedules itself again, and optionally reschedules/deschedules other
+// pending events.
+
+typedef struct _Workload {
+  const char *name;
+  uint64_t minDistance;  // ps
+  uint64_t maxDistance;  // ps
+  uint32_t reschedule;   // Reschedule of other pending events per dispatch
+  uint32_t deschedule;   // Deschedule + schedule of other events per dispatch
+} Workload;
+
+const Workload workloadList[] = {
+    {"Random (1ns~1ms)", 1000ull, 1000000000ull, 0, 0},
+    {"Near future (1ns~10us)", 1000ull, 10000000ull, 0, 0},
+    {"Far future (1ms~1s)", 1000000000ull, 1000000000000ull, 0, 0},
+    {"Same tick heavy (0~4ns)", 0ull, 4000ull, 0, 0},
+    {"Reschedule heavy", 1000ull, 1000000000ull, 4, 0},
+    {"Deschedule heavy", 1000ull, 1000000000ull, 0, 4},
+};
+
+const char *queueName[EVENT_QUEUE_NUM] = {"Heap", "Wheel"};
+
+class Bench {
+ private:
+  Engine engine;
+  const Workload &workload;
+
+  std::vector<SimpleSSD::Event> eventList;
+  uint64_t seed;
+  uint64_t handled;
+
+  // xorshift64* - cheap enough not to dominate measurement
+  uint64_t random() {
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+
+    return seed * 2685821657736338717ull;
+  }
+
+  uint64_t distance() {
+    return workload.minDistance +
+           random() % (workload.maxDistance - workload.minDistance + 1);
+  }
+
+  SimpleSSD::Event other() { return eventList[random() % eventList.size()]; }
+
+  void fire(uint32_t idx, uint64_t tick) {
+    handled++;
+
+    engine.scheduleEvent(eventList[idx], tick + distance());
+
+    for (uint32_t i = 0; i < workload.reschedule; i++) {
+      engine.scheduleEvent(other(), tick + distance());
+    }
+
+    for (uint32_t i = 0; i < workload.deschedule; i++) {
+      SimpleSSD::Event eid = other();
+
+      engine.descheduleEvent(eid);
+      engine.scheduleEvent(eid, tick + distance());
+    }
+  }
+
+ public:
+  Bench(EVENT_QUEUE type, const Workload &w, uint64_t pending)
+      : engine(type), workload(w), seed(0x9E3779B97F4A7C15ull), handled(0) {
+    eventList.reserve(pending);
+
+    for (uint64_t i = 0; i < pending; i++) {
+      uint32_t idx = (uint32_t)i;
+
+      eventList.push_back(engine.allocateEvent(
+          [this, idx](uint64_t tick) { fire(idx, tick); }));
+    }
+
+    for (auto eid : eventList) {
+      engine.scheduleEvent(eid, distance());
+    }
+  }
+
+  double run(uint64_t count) {
+    Stopwatch watch;
+
+    watch.start();
+
+    while (handled < count && engine.doNextBatch())
+      ;
+
+    watch.stop();
+
+    return watch.getDuration();
+  }
+
+  uint64_t getHandled() { return handled; }
+};
+
+int main(int argc, char *argv[]) {
+  uint64_t count = 1000000;
+  std::vector<uint64_t> pendingList = {64, 4096, 262144};
+
+  if (argc > 3) {
+    fprintf(stderr, "Usage: bench-engine [Number of events] [Number of "
+                    "pending events]\n");
+
+    return 1;
+  }
+  if (argc > 1) {
+    count = strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    pendingList = {strtoull(argv[2], nullptr, 10)};
+  }
+
+  if (count == 0 || pendingList.front() == 0) {
+    fprintf(stderr, "Invalid argument\n");
+
+    return 1;
+  }
+
+  printf("%-26s %-6s %10s %12s %14s %10s\n", "Workload", "Queue", "Pending",
+         "Events", "Events/s", "ns/event");
+
+  for (auto &workload : workloadList) {
+    for (auto pending : pendingList) {
+      for (int type = 0; type < EVENT_QUEUE_NUM; type++) {
+        Bench bench((EVENT_QUEUE)type, workload, pending);
+        double duration = bench.run(count);
+        uint64_t handled = bench.getHandled();
+
+        printf("%-26s %-6s %10" PRIu64 " %12" PRIu64 " %14.0lf %10.2lf\n",
+               workload.name, queueName[type], pending, handled,
+               handled / duration, duration * 1e9 / handled);
+        fflush(stdout);
+      }
+    }
+  }
+
+  return 0;
+}
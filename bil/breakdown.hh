@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __BIL_BREAKDOWN__
+#define __BIL_BREAKDOWN__
+
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+
+namespace BIL {
+
+// Boundaries crossed by BIO, in path order
+enum BIO_STAGE : uint8_t {
+  STAGE_GENERATE,   // Created by I/O generator
+  STAGE_SUBMIT,     // Received by block I/O entry
+  STAGE_DISPATCH,   // Passed from scheduler to driver
+  STAGE_DOORBELL,   // Submission queue doorbell rung
+  STAGE_DMA_FIRST,  // First DMA began
+  STAGE_DMA_LAST,   // Last DMA finished
+  STAGE_INTERRUPT,  // Completion queue entry found
+  STAGE_CALLBACK,   // Completion received by block I/O entry
+  STAGE_NUM,
+};
+
+// Stage N is from previous crossed boundary to boundary N + 1
+const uint32_t BREAKDOWN_NUM = STAGE_NUM - 1;
+
+// Boundary not crossed (e.g. no DMA for flush)
+const uint64_t NO_STAMP = std::numeric_limits<uint64_t>::max();
+
+// Tick at each boundary, owned by block I/O entry and stamped by lower layers
+typedef struct _Breakdown {
+  uint64_t tick[STAGE_NUM];
+
+  void reset() { std::fill(tick, tick + STAGE_NUM, NO_STAMP); }
+
+  // Fills BREAKDOWN_NUM stage latencies, NO_STAMP if boundary not crossed
+  void getStage(uint64_t *stage) {
+    uint64_t prev = tick[STAGE_GENERATE];
+
+    for (uint32_t i = 0; i < BREAKDOWN_NUM; i++) {
+      if (tick[i + 1] == NO_STAMP) {
+        stage[i] = NO_STAMP;
+      }
+      else {
+        stage[i] = tick[i + 1] - prev;
+        prev = tick[i + 1];
+      }
+    }
+  }
+} Breakdown;
+
+}  // namespace BIL
+
+#endif
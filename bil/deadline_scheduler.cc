@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bil/deadline_scheduler.hh"
+
+#include <limits>
+
+namespace BIL {
+
+const uint64_t NO_SLOT = std::numeric_limits<uint64_t>::max();
+
+DeadlineScheduler::DeadlineScheduler(Engine &e, DriverInterface *i,
+                                     ConfigReader &c)
+    : Scheduler(e, i),
+      inflight(0),
+      queued(0),
+      batching(0),
+      starved(0) {
+  maxDepth = c.readUint(CONFIG_GLOBAL, GLOBAL_SCHEDULER_DEPTH);
+  expire[DIR_READ] = c.readUint(CONFIG_GLOBAL, GLOBAL_DEADLINE_READ_EXPIRE);
+  expire[DIR_WRITE] = c.readUint(CONFIG_GLOBAL, GLOBAL_DEADLINE_WRITE_EXPIRE);
+  writesStarved = c.readUint(CONFIG_GLOBAL, GLOBAL_DEADLINE_WRITES_STARVED);
+  fifoBatch = c.readUint(CONFIG_GLOBAL, GLOBAL_DEADLINE_FIFO_BATCH);
+
+  nextSlot[DIR_READ] = NO_SLOT;
+  nextSlot[DIR_WRITE] = NO_SLOT;
+
+  resetStats();
+}
+
+DeadlineScheduler::~DeadlineScheduler() {}
+
+void DeadlineScheduler::init() {}
+
+void DeadlineScheduler::submitIO(BIO &bio) {
+  uint64_t slot;
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = requestList.size();
+    requestList.emplace_back();
+  }
+
+  auto &req = requestList[slot];
+
+  req.bio = std::move(bio);
+
+  if (req.bio.type == BIO_FLUSH) {
+    flushList.push_back(slot);
+  }
+  else {
+    DIRECTION dir = req.bio.type == BIO_READ ? DIR_READ : DIR_WRITE;
+
+    req.deadline = engine.getCurrentTick() + expire[dir];
+    req.sortIter = sortList[dir].emplace(req.bio.offset, slot);
+    req.fifoIter = fifoList[dir].insert(fifoList[dir].end(), slot);
+  }
+
+  queued++;
+
+  if (maxQueued < queued) {
+    maxQueued = queued;
+  }
+
+  run();
+}
+
+void DeadlineScheduler::run() {
+  while (inflight < maxDepth) {
+    uint64_t slot = selectRequest();
+
+    if (slot == NO_SLOT) {
+      break;
+    }
+
+    auto &req = requestList[slot];
+    BIO bio;
+
+    // Callback is kept here and called on completion
+
+    bio.id = req.bio.id;
+    bio.type = req.bio.type;
+    bio.offset = req.bio.offset;
+    bio.length = req.bio.length;
+    bio.submittedAt = req.bio.submittedAt;
+    bio.breakdown = req.bio.breakdown;
+    bio.callback = [this, slot](uint64_t) { completion(slot); };
+
+    dispatchCount[bio.type]++;
+    queued--;
+    inflight++;
+
+    dispatch(bio);
+  }
+}
+
+uint64_t DeadlineScheduler::selectRequest() {
+  uint64_t slot = NO_SLOT;
+  uint32_t dir = DIR_READ;
+
+  if (flushList.size() > 0) {
+    slot = flushList.front();
+    flushList.pop_front();
+
+    return slot;
+  }
+
+  // Continue current batch
+  if (nextSlot[DIR_WRITE] != NO_SLOT) {
+    dir = DIR_WRITE;
+    slot = nextSlot[DIR_WRITE];
+  }
+  else if (nextSlot[DIR_READ] != NO_SLOT) {
+    dir = DIR_READ;
+    slot = nextSlot[DIR_READ];
+  }
+
+  if (slot == NO_SLOT || batching >= fifoBatch) {
+    // Start new batch
+    bool reads = fifoList[DIR_READ].size() > 0;
+    bool writes = fifoList[DIR_WRITE].size() > 0;
+
+    if (reads && !(writes && starved++ >= writesStarved)) {
+      dir = DIR_READ;
+    }
+    else if (writes) {
+      if (reads) {
+        starveCount++;
+      }
+
+      dir = DIR_WRITE;
+      starved = 0;
+    }
+    else {
+      return NO_SLOT;
+    }
+
+    // Start from oldest BIO when expired, otherwise continue in offset order
+    uint64_t oldest = fifoList[dir].front();
+
+    if (requestList[oldest].deadline <= engine.getCurrentTick()) {
+      expireCount[dir]++;
+      slot = oldest;
+    }
+    else if (nextSlot[dir] != NO_SLOT) {
+      slot = nextSlot[dir];
+    }
+    else {
+      slot = oldest;
+    }
+
+    batching = 0;
+    batchCount++;
+  }
+
+  auto &req = requestList[slot];
+  auto next = std::next(req.sortIter);
+
+  nextSlot[DIR_READ] = NO_SLOT;
+  nextSlot[DIR_WRITE] = NO_SLOT;
+
+  if (next != sortList[dir].end()) {
+    nextSlot[dir] = next->second;
+  }
+
+  sortList[dir].erase(req.sortIter);
+  fifoList[dir].erase(req.fifoIter);
+  batching++;
+
+  return slot;
+}
+
+void DeadlineScheduler::completion(uint64_t slot) {
+  auto &req = requestList[slot];
+
+  // Callback may submit new BIO, which may reuse this slot
+  uint64_t id = req.bio.id;
+  BIOFunction callback = std::move(req.bio.callback);
+
+  inflight--;
+  freeSlot.push_back(slot);
+
+  callback(id);
+
+  run();
+}
+
+void DeadlineScheduler::printStats(std::ostream &out) {
+  out << "*** Statistics of mq-deadline Scheduler ***" << std::endl;
+  out << "Dispatched (counts): Read: " << dispatchCount[BIO_READ]
+      << ", Write: " << dispatchCount[BIO_WRITE]
+      << ", Flush: " << dispatchCount[BIO_FLUSH]
+      << ", Trim: " << dispatchCount[BIO_TRIM] << std::endl;
+  out << "Batches: " << batchCount
+      << " (Read expired: " << expireCount[DIR_READ]
+      << ", Write expired: " << expireCount[DIR_WRITE]
+      << ", Write starved: " << starveCount << ")" << std::endl;
+  out << "Max queued BIOs: " << maxQueued << std::endl;
+  out << "*** End of statistics ***" << std::endl;
+}
+
+void DeadlineScheduler::resetStats() {
+  for (uint32_t i = 0; i < BIO_NUM; i++) {
+    dispatchCount[i] = 0;
+  }
+
+  expireCount[DIR_READ] = 0;
+  expireCount[DIR_WRITE] = 0;
+  batchCount = 0;
+  starveCount = 0;
+  maxQueued = queued;
+}
+
+}  // namespace BIL
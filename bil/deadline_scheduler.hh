@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __BIL_DEADLINE_SCHEDULER__
+#define __BIL_DEADLINE_SCHEDULER__
+
+#include <deque>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "bil/scheduler.hh"
+
+namespace BIL {
+
+// Same policy with mq-deadline of Linux
+// Reads and writes are sorted by offset and dispatched in batches. Batch
+// starts at oldest BIO when its deadline expired. Reads are preferred, but
+// writes are dispatched after they are passed over by reads several times.
+class DeadlineScheduler : public Scheduler {
+ private:
+  enum DIRECTION {
+    DIR_READ,
+    DIR_WRITE,  // Write and trim
+    DIR_NUM,
+  };
+
+  typedef std::multimap<uint64_t, uint64_t> SortList;  // Offset to slot
+
+  typedef struct _Request {
+    BIO bio;
+    uint64_t deadline;
+    SortList::iterator sortIter;
+    std::list<uint64_t>::iterator fifoIter;
+  } Request;
+
+  // Queued and dispatched BIOs, indexed by slot ID
+  std::vector<Request> requestList;
+  std::vector<uint64_t> freeSlot;
+
+  SortList sortList[DIR_NUM];
+  std::list<uint64_t> fifoList[DIR_NUM];  // In deadline order
+  std::deque<uint64_t> flushList;         // Dispatched before others
+
+  // Configuration
+  uint64_t maxDepth;  // BIOs in driver
+  uint64_t expire[DIR_NUM];
+  uint64_t writesStarved;
+  uint64_t fifoBatch;
+
+  // Dispatch state
+  uint64_t inflight;
+  uint64_t queued;
+  uint64_t nextSlot[DIR_NUM];  // Next BIO of current batch in offset order
+  uint64_t batching;           // BIOs dispatched in current batch
+  uint64_t starved;            // Times writes are passed over
+
+  // Statistics
+  uint64_t dispatchCount[BIO_NUM];
+  uint64_t expireCount[DIR_NUM];
+  uint64_t batchCount;
+  uint64_t starveCount;
+  uint64_t maxQueued;
+
+  void run();
+  uint64_t selectRequest();
+  void completion(uint64_t);
+
+ public:
+  DeadlineScheduler(Engine &, DriverInterface *, ConfigReader &);
+  ~DeadlineScheduler();
+
+  void init() override;
+  void submitIO(BIO &) override;
+
+  void printStats(std::ostream &) override;
+  void resetStats() override;
+};
+
+}  // namespace BIL
+
+#endif
@@ -19,33 +19,116 @@
 
 #include "bil/entry.hh"
 
+#include <algorithm>
 #include <cmath>
 
+#include "bil/deadline_scheduler.hh"
 #include "bil/interface.hh"
+#include "bil/kyber_scheduler.hh"
 #include "bil/noop_scheduler.hh"
+#include "bil/plug.hh"
 #include "simplessd/sim/trace.hh"
+#include "util/print.hh"
 
 namespace BIL {
 
+// Window ID of I/O excluded from statistics
+const uint64_t NO_WINDOW = std::numeric_limits<uint64_t>::max();
+
+const char *TYPE_NAME[BIO_NUM] = {"Read", "Write", "Flush", "Trim"};
+const char *TYPE_PREFIX[BIO_NUM] = {"bil.read", "bil.write", "bil.flush",
+                                    "bil.trim"};
+const char *STAGE_NAME[STAGE_NUM] = {
+    "Generator", "Entry",    "Dispatch",  "Doorbell",
+    "First DMA", "Last DMA", "Interrupt", "Callback",
+};
+
+// Two-sided 95% critical values of Student's t-distribution, df = 1 - 30
+const double T_TABLE[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+// Mean and half width of 95% confidence interval
+static void estimate(std::vector<double> &list, double &mean, double &ci) {
+  uint64_t n = list.size();
+  double sum = 0.;
+  double var = 0.;
+
+  mean = 0.;
+  ci = 0.;
+
+  if (n == 0) {
+    return;
+  }
+
+  for (auto &value : list) {
+    sum += value;
+  }
+
+  mean = sum / n;
+
+  if (n == 1) {
+    return;
+  }
+
+  for (auto &value : list) {
+    var += (value - mean) * (value - mean);
+  }
+
+  var /= n - 1;
+  ci = (n <= 31 ? T_TABLE[n - 2] : 1.96) * sqrt(var / n);
+}
+
 BlockIOEntry::BlockIOEntry(ConfigReader &c, Engine &e, DriverInterface *i,
-                           std::ostream *o)
+                           LatencyLog *o)
     : conf(c),
       engine(e),
-      pLatencyFile(o),
+      breakdown(c.readBoolean(CONFIG_GLOBAL, GLOBAL_LATENCY_BREAKDOWN)),
+      pLatencyLog(o),
+      functional(false),
+      sampleIndex(0),
       pScheduler(nullptr),
+      pPlug(nullptr),
       pDriver(i),
-      lastProgress(0),
-      io_progress(0),
+      pMirror(nullptr),
       io_count(0),
+      io_bytes(0),
+      resetAt(0),
       minLatency(std::numeric_limits<uint64_t>::max()),
       maxLatency(0),
       sumLatency(0),
-      squareSumLatency(0),
-      callback([this](uint64_t id) { completion(id); }) {
+      squareSumLatency(0.),
+      latencyHistogram(LATENCY_PRECISION),
+      typeHistogram(BIO_NUM, Histogram(LATENCY_PRECISION)),
+      intervalHistogram(BIO_NUM, Histogram(LATENCY_PRECISION)),
+      stageHistogram(breakdown ? BREAKDOWN_NUM : 0,
+                     Histogram(LATENCY_PRECISION)) {
+  // Slots for configured queue depth are allocated in advance
+  uint64_t depth =
+      std::max({c.readUint(CONFIG_REQ_GEN, IGL::REQUEST_IO_DEPTH),
+                c.readUint(CONFIG_TRACE, IGL::TRACE_QUEUE_DEPTH),
+                c.readUint(CONFIG_GLOBAL, GLOBAL_PRECONDITION_DEPTH)});
+
+  pendingIO.reserve(depth);
+  freeSlot.reserve(depth);
+
+  samplingPeriod = c.readUint(CONFIG_GLOBAL, GLOBAL_SAMPLING_PERIOD);
+  samplingWindow = c.readUint(CONFIG_GLOBAL, GLOBAL_SAMPLING_WINDOW);
+
   switch (c.readUint(CONFIG_GLOBAL, GLOBAL_SCHEDULER)) {
     case SCHEDULER_NOOP:
       pScheduler = new NoopScheduler(e, i);
 
+      break;
+    case SCHEDULER_DEADLINE:
+      pScheduler = new DeadlineScheduler(e, i, c);
+
+      break;
+    case SCHEDULER_KYBER:
+      pScheduler = new KyberScheduler(e, i, c);
+
       break;
     default:
       SimpleSSD::panic("Invalid I/O scheduler specified");
@@ -54,138 +137,361 @@ BlockIOEntry::BlockIOEntry(ConfigReader &c, Engine &e, DriverInterface *i,
   }
 
   pScheduler->init();
+
+  if (c.readUint(CONFIG_GLOBAL, GLOBAL_PLUG_WINDOW) > 0) {
+    pPlug = new Plug(e, pScheduler, c);
+  }
 }
 
 BlockIOEntry::~BlockIOEntry() {
+  delete pPlug;
   delete pScheduler;
 }
 
 void BlockIOEntry::submitIO(BIO &bio) {
-  BIO copy(bio);
+  BIO copy;
+  uint64_t window = selectWindow();
+  uint64_t slot;
+
+  if (pMirror) {
+    pMirror->submitIO(bio);
+  }
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = pendingIO.size();
+    pendingIO.emplace_back();
+  }
+
+  copy.id = bio.id;
+  copy.type = bio.type;
+  copy.offset = bio.offset;
+  copy.length = bio.length;
+  copy.submittedAt = bio.submittedAt;
+  copy.callback = [this, slot](uint64_t) { completion(slot); };
+
+  if (breakdown) {
+    if (breakdownList.size() <= slot) {
+      breakdownList.resize(slot + 1);
+    }
+
+    auto &stamp = breakdownList[slot];
+
+    // Generator sets submission tick of BIO
+    stamp.reset();
+    stamp.tick[STAGE_GENERATE] = bio.submittedAt;
+    stamp.tick[STAGE_SUBMIT] = engine.getCurrentTick();
+    copy.breakdown = &stamp;
+  }
+
+  if (window != NO_WINDOW) {
+    io_count++;
+  }
 
-  io_count++;
   bio.submittedAt = engine.getCurrentTick();
 
-  ioQueue.push_back(bio);
-  copy.callback = callback;
+  auto &io = pendingIO[slot];
+
+  io.bio = std::move(bio);
+  io.window = window;
 
-  pScheduler->submitIO(copy);
+  if (pPlug) {
+    pPlug->submitIO(copy);
+  }
+  else {
+    pScheduler->submitIO(copy);
+  }
 }
 
-void BlockIOEntry::completion(uint64_t id) {
+uint64_t BlockIOEntry::selectWindow() {
+  if (functional) {
+    return NO_WINDOW;
+  }
+  if (samplingPeriod == 0) {
+    return 0;
+  }
+
+  uint64_t pos = sampleIndex % samplingPeriod;
+  uint64_t window = sampleIndex / samplingPeriod;
+
+  sampleIndex++;
+
+  // I/Os out of window are simulated in detail, but not measured
+  if (pos < samplingPeriod - samplingWindow) {
+    return NO_WINDOW;
+  }
+
+  if (sampleList.size() <= window) {
+    sampleList.resize(window + 1);
+    sampleList.back().beginAt = engine.getCurrentTick();
+  }
+
+  return window;
+}
+
+void BlockIOEntry::completion(uint64_t slot) {
   uint64_t tick = engine.getCurrentTick();
+  auto &io = pendingIO[slot];
+  auto &bio = io.bio;
+  uint64_t latency = tick - bio.submittedAt;
+  uint64_t stage[BREAKDOWN_NUM];
 
-  for (auto iter = ioQueue.begin(); iter != ioQueue.end(); iter++) {
-    if (iter->id == id) {
-      tick = tick - iter->submittedAt;
+  if (breakdown) {
+    auto &stamp = breakdownList[slot];
 
-      {
-        std::lock_guard<std::mutex> guard(m);
+    stamp.tick[STAGE_CALLBACK] = tick;
+    stamp.getStage(stage);
+  }
 
-        io_progress++;
+  // Published by engine after this event
+  auto &telemetry = engine.getTelemetry();
 
-        progress.latency += tick;
-        progress.iops++;
-        progress.bandwidth += iter->length;
-      }
+  telemetry.ioCount++;
+  telemetry.ioBytes += bio.length;
+  telemetry.ioLatency += latency;
+
+  if (io.window != NO_WINDOW) {
+    if (pLatencyLog) {
+      pLatencyLog->write(bio.id, bio.type, bio.offset, bio.length,
+                         bio.submittedAt, latency,
+                         breakdown ? stage : nullptr);
+    }
 
-      if (pLatencyFile) {
-        *pLatencyFile << std::to_string(iter->id) << ", "
-                      << std::to_string(iter->offset) << ", "
-                      << std::to_string(iter->length) << ", "
-                      << std::to_string(tick) << std::endl;
+    if (breakdown) {
+      for (uint32_t i = 0; i < BREAKDOWN_NUM; i++) {
+        if (stage[i] != NO_STAMP) {
+          stageHistogram[i].add(stage[i]);
+        }
       }
+    }
 
-      iter->callback(id);
+    if (minLatency > latency) {
+      minLatency = latency;
+    }
+    if (maxLatency < latency) {
+      maxLatency = latency;
+    }
 
-      ioQueue.erase(iter);
+    io_bytes += bio.length;
+    sumLatency += latency;
+    squareSumLatency += (double)latency * latency;
+    latencyHistogram.add(latency);
+    typeHistogram[bio.type].add(latency);
+    intervalHistogram[bio.type].add(latency);
 
-      break;
+    if (samplingPeriod > 0) {
+      auto &sample = sampleList[io.window];
+
+      sample.count++;
+      sample.bytes += bio.length;
+      sample.sumLatency += latency;
+      sample.endAt = tick;
     }
   }
 
-  if (minLatency > tick) {
-    minLatency = tick;
+  // Callback may submit new I/O, which may reuse this slot
+  uint64_t id = bio.id;
+  BIOFunction callback = std::move(bio.callback);
+
+  freeSlot.push_back(slot);
+
+  callback(id);
+}
+
+void BlockIOEntry::setFunctionalMode(bool enable) {
+  functional = enable;
+
+  pDriver->setFunctionalMode(enable);
+
+  if (pMirror) {
+    pMirror->setFunctionalMode(enable);
+  }
+}
+
+void BlockIOEntry::resetStats() {
+  io_count = 0;
+  io_bytes = 0;
+  resetAt = engine.getCurrentTick();
+  minLatency = std::numeric_limits<uint64_t>::max();
+  maxLatency = 0;
+  sumLatency = 0;
+  squareSumLatency = 0.;
+  latencyHistogram.reset();
+
+  for (uint32_t i = 0; i < BIO_NUM; i++) {
+    typeHistogram[i].reset();
+    intervalHistogram[i].reset();
   }
-  if (maxLatency < tick) {
-    maxLatency = tick;
+
+  for (auto &hist : stageHistogram) {
+    hist.reset();
   }
 
-  sumLatency += tick;
-  squareSumLatency += tick * tick;
+  sampleIndex = 0;
+  sampleList.clear();
+
+  pScheduler->resetStats();
+
+  if (pPlug) {
+    pPlug->resetStats();
+  }
+
+  if (pMirror) {
+    pMirror->resetStats();
+  }
 }
 
 void BlockIOEntry::printStats(std::ostream &out) {
-  double avgLatency = (double)sumLatency / io_count;
-  double stdevLatency = sqrt((double)squareSumLatency / io_count - avgLatency);
+  uint64_t count = latencyHistogram.getCount();
+  double avgLatency = count > 0 ? (double)sumLatency / count : 0.;
+  double variance =
+      count > 0 ? squareSumLatency / count - avgLatency * avgLatency : 0.;
+  double stdevLatency = sqrt(std::max(variance, 0.));
   double digit = log10(avgLatency);
-
-  out << "*** Statistics of Block I/O Entry ***" << std::endl;
+  const char *unit = "ms";
+  double divisor = 1000000000.0;
 
   if (digit < 6.0) {
-    out << "Latency (ps): min=" << std::to_string(minLatency)
-        << ", max=" << std::to_string(maxLatency)
-        << ", avg=" << std::to_string(avgLatency)
-        << ", stdev=" << std::to_string(stdevLatency) << std::endl;
+    unit = "ps";
+    divisor = 1.0;
   }
   else if (digit < 9.0) {
-    out << "Latency (ns): min=" << std::to_string(minLatency / 1000.0)
-        << ", max=" << std::to_string(maxLatency / 1000.0)
-        << ", avg=" << std::to_string(avgLatency / 1000.0)
-        << ", stdev=" << std::to_string(stdevLatency / 31.62277660168)
-        << std::endl;
+    unit = "ns";
+    divisor = 1000.0;
   }
   else if (digit < 12.0) {
-    out << "Latency (us): min=" << std::to_string(minLatency / 1000000.0)
-        << ", max=" << std::to_string(maxLatency / 1000000.0)
-        << ", avg=" << std::to_string(avgLatency / 1000000.0)
-        << ", stdev=" << std::to_string(stdevLatency / 1000.0) << std::endl;
+    unit = "us";
+    divisor = 1000000.0;
   }
-  else {
-    out << "Latency (ms): min=" << std::to_string(minLatency / 1000000000.0)
-        << ", max=" << std::to_string(maxLatency / 1000000000.0)
-        << ", avg=" << std::to_string(avgLatency / 1000000000.0)
-        << ", stdev=" << std::to_string(stdevLatency / 31622.77660168379)
-        << std::endl;
+
+  out << "*** Statistics of Block I/O Entry ***" << std::endl;
+  out << "Latency (" << unit << "): min="
+      << std::to_string((count > 0 ? minLatency : 0) / divisor)
+      << ", max=" << std::to_string(maxLatency / divisor)
+      << ", avg=" << std::to_string(avgLatency / divisor)
+      << ", stdev=" << std::to_string(stdevLatency / divisor) << std::endl;
+
+  for (uint32_t i = 0; i < BIO_NUM; i++) {
+    auto &hist = typeHistogram[i];
+
+    if (hist.getCount() == 0) {
+      continue;
+    }
+
+    out << TYPE_NAME[i] << " latency (" << unit
+        << "): count=" << hist.getCount()
+        << ", p50=" << std::to_string(hist.getPercentile(50.) / divisor)
+        << ", p90=" << std::to_string(hist.getPercentile(90.) / divisor)
+        << ", p99=" << std::to_string(hist.getPercentile(99.) / divisor)
+        << ", p99.9=" << std::to_string(hist.getPercentile(99.9) / divisor)
+        << ", p99.99=" << std::to_string(hist.getPercentile(99.99) / divisor)
+        << ", max=" << std::to_string(hist.getMax() / divisor) << std::endl;
   }
 
-  out << "*** End of statistics ***" << std::endl;
-}
+  // Each stage ends at named boundary and begins at previous crossed one
+  for (uint32_t i = 0; i < stageHistogram.size(); i++) {
+    auto &hist = stageHistogram[i];
 
-void BlockIOEntry::getProgress(Progress &data) {
-  uint64_t tick = engine.getCurrentTick();
-  uint64_t diff = tick - lastProgress;
+    if (hist.getCount() == 0) {
+      continue;
+    }
 
-  if (diff == 0) {
-    data.iops = 0;
-    data.bandwidth = 0;
-    data.latency = 0;
+    out << "Stage until " << STAGE_NAME[i + 1] << " (" << unit
+        << "): count=" << hist.getCount()
+        << ", avg=" << std::to_string(hist.getMean() / divisor)
+        << ", p50=" << std::to_string(hist.getPercentile(50.) / divisor)
+        << ", p99=" << std::to_string(hist.getPercentile(99.) / divisor)
+        << ", max=" << std::to_string(hist.getMax() / divisor) << std::endl;
+  }
 
-    return;
+  if (samplingPeriod > 0) {
+    printSampling(out);
+  }
+
+  out << "*** End of statistics ***" << std::endl;
+
+  if (pPlug) {
+    pPlug->printStats(out);
   }
 
-  double ratio = 1000000000000.0 / diff;
+  pScheduler->printStats(out);
+}
 
-  {
-    std::lock_guard<std::mutex> guard(m);
+void BlockIOEntry::printInterval(std::ostream &out) {
+  const double percentile[] = {50., 90., 99., 99.9, 99.99};
+  const char *suffix[] = {".p50", ".p90", ".p99", ".p99.9", ".p99.99"};
 
-    data.iops = progress.iops * ratio;
-    data.bandwidth = progress.bandwidth * ratio;
+  for (uint32_t i = 0; i < BIO_NUM; i++) {
+    auto &hist = intervalHistogram[i];
+    std::string prefix(TYPE_PREFIX[i]);
 
-    if (io_progress == 0) {
-      data.latency = 0;
+    if (hist.getCount() == 0) {
+      continue;
     }
-    else {
-      data.latency = progress.latency / io_progress;
+
+    print(out, prefix + ".count", 40);
+    out << "\t";
+    print(out, (double)hist.getCount(), 20);
+    out << "\tCompleted I/O in interval" << std::endl;
+
+    for (uint32_t j = 0; j < 5; j++) {
+      print(out, prefix + suffix[j], 40);
+      out << "\t";
+      print(out, (double)hist.getPercentile(percentile[j]), 20);
+      out << "\tLatency percentile in interval (ps)" << std::endl;
     }
 
-    io_progress = 0;
-    progress.iops = 0;
-    progress.bandwidth = 0;
-    progress.latency = 0;
+    print(out, prefix + ".max", 40);
+    out << "\t";
+    print(out, (double)hist.getMax(), 20);
+    out << "\tMaximum latency in interval (ps)" << std::endl;
+
+    hist.reset();
   }
 
-  lastProgress = tick;
+  pScheduler->printInterval(out);
+}
+
+void BlockIOEntry::printSampling(std::ostream &out) {
+  std::vector<double> latency;
+  std::vector<double> bandwidth;
+  std::vector<double> iops;
+  double mean;
+  double ci;
+
+  for (auto &sample : sampleList) {
+    if (sample.count == 0) {
+      continue;
+    }
+
+    latency.push_back((double)sample.sumLatency / sample.count);
+
+    // Window with single I/O has no duration
+    if (sample.endAt > sample.beginAt) {
+      double duration = (sample.endAt - sample.beginAt) / 1000000000000.;
+
+      bandwidth.push_back(sample.bytes / duration);
+      iops.push_back(sample.count / duration);
+    }
+  }
+
+  out << "Sampling: " << latency.size() << " windows of " << samplingWindow
+      << " I/Os per " << samplingPeriod << " I/Os" << std::endl;
+
+  estimate(latency, mean, ci);
+  out << "Sampled latency (ps): " << std::to_string(mean) << " +/- "
+      << std::to_string(ci) << " (95% CI)" << std::endl;
+
+  estimate(bandwidth, mean, ci);
+  out << "Sampled bandwidth (B/s): " << std::to_string(mean) << " +/- "
+      << std::to_string(ci) << " (95% CI)" << std::endl;
+
+  estimate(iops, mean, ci);
+  out << "Sampled IOPS: " << std::to_string(mean) << " +/- "
+      << std::to_string(ci) << " (95% CI)" << std::endl;
 }
 
 }  // namespace BIL
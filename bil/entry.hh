@@ -23,16 +23,22 @@
 #define __BIL_ENTRY__
 
 #include <cinttypes>
+#include <deque>
 #include <fstream>
 #include <functional>
-#include <list>
+#include <vector>
 
+#include "bil/breakdown.hh"
+#include "bil/latency_log.hh"
 #include "sim/cfg_reader.hh"
 #include "sim/engine.hh"
+#include "util/delegate.hh"
+#include "util/histogram.hh"
 
 namespace BIL {
 
 class Scheduler;
+class Plug;
 class DriverInterface;
 
 enum BIO_TYPE : uint8_t {
@@ -43,6 +49,10 @@ enum BIO_TYPE : uint8_t {
   BIO_NUM,
 };
 
+// Completion callback of BIO, called with BIO ID
+typedef Delegate<void(uint64_t)> BIOFunction;
+
+// BIO is move-only - callback is moved to the layer which handles the BIO
 typedef struct _BIO {
   uint64_t id;
 
@@ -52,54 +62,116 @@ typedef struct _BIO {
   uint64_t length;
 
   // I/O completion
-  std::function<void(uint64_t)> callback;
+  BIOFunction callback;
 
   // Statistics
   uint64_t submittedAt;
-
-  _BIO() : id(0), type(BIO_READ), offset(0), length(0), submittedAt(0) {}
+  Breakdown *breakdown;  // nullptr when breakdown disabled
+
+  _BIO()
+      : id(0),
+        type(BIO_READ),
+        offset(0),
+        length(0),
+        submittedAt(0),
+        breakdown(nullptr) {}
 } BIO;
 
-typedef struct _Progress {
-  uint64_t iops;
-  uint64_t bandwidth;
-  uint64_t latency;
-} Progress;
+// Receives I/O stream of block I/O entry (differential mode)
+class Mirror {
+ public:
+  virtual ~Mirror() {}
+
+  // Called before submission, may replace callback of BIO
+  virtual void submitIO(BIO &) = 0;
+  virtual void resetStats() = 0;
+  virtual void setFunctionalMode(bool) = 0;
+};
 
 class BlockIOEntry {
  private:
   ConfigReader &conf;
   Engine &engine;
-  std::list<BIO> ioQueue;
 
-  std::ostream *pLatencyFile;
+  typedef struct _PendingIO {
+    BIO bio;
+    uint64_t window;
+  } PendingIO;
+
+  // Submitted I/O, indexed by slot ID (captured by completion callback)
+  std::vector<PendingIO> pendingIO;
+  std::vector<uint64_t> freeSlot;
+
+  // Indexed by slot ID, empty when breakdown disabled
+  // Lower layers hold element pointers, so deque is used here.
+  std::deque<Breakdown> breakdownList;
+  bool breakdown;
+
+  typedef struct _SampleWindow {
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t sumLatency;
+    uint64_t beginAt;  // First submission
+    uint64_t endAt;    // Last completion
+
+    _SampleWindow()
+        : count(0), bytes(0), sumLatency(0), beginAt(0), endAt(0) {}
+  } SampleWindow;
+
+  LatencyLog *pLatencyLog;
+  bool functional;  // Do not log latency when set
+
+  // Systematic sampling (in I/O counts)
+  // All I/Os are simulated in detail, and last window of each period is
+  // measured
+  uint64_t samplingPeriod;
+  uint64_t samplingWindow;
+  uint64_t sampleIndex;
+  std::vector<SampleWindow> sampleList;
 
   Scheduler *pScheduler;
+  Plug *pPlug;  // nullptr when plugging disabled
   DriverInterface *pDriver;
-
-  std::mutex m;
-  uint64_t lastProgress;
-  uint64_t io_progress;
-  Progress progress;
+  Mirror *pMirror;
 
   // Statistics
   uint64_t io_count;
+  uint64_t io_bytes;  // Completed
+  uint64_t resetAt;
   uint64_t minLatency;
   uint64_t maxLatency;
   uint64_t sumLatency;
-  uint64_t squareSumLatency;
+  double squareSumLatency;  // Overflows in uint64_t with ms scale latency
+  Histogram latencyHistogram;
+  std::vector<Histogram> typeHistogram;      // Indexed by BIO_TYPE
+  std::vector<Histogram> intervalHistogram;  // Reset by printInterval
+  std::vector<Histogram> stageHistogram;     // Indexed by stage
 
-  std::function<void(uint64_t)> callback;
   void completion(uint64_t);
+  uint64_t selectWindow();
+  void printSampling(std::ostream &);
 
  public:
-  BlockIOEntry(ConfigReader &, Engine &, DriverInterface *, std::ostream *);
+  BlockIOEntry(ConfigReader &, Engine &, DriverInterface *, LatencyLog *);
   ~BlockIOEntry();
 
   void submitIO(BIO &);
 
   void printStats(std::ostream &);
-  void getProgress(Progress &);
+  void resetStats();
+
+  // Latency percentiles since last call, in periodic log format
+  void printInterval(std::ostream &);
+
+  // Latency of measured I/Os
+  Histogram &getLatency() { return latencyHistogram; }
+  uint64_t getBytes() { return io_bytes; }
+  uint64_t getDuration() { return engine.getCurrentTick() - resetAt; }
+
+  // Propagated to driver
+  void setFunctionalMode(bool);
+
+  void setMirror(Mirror *m) { pMirror = m; }
 };
 
 }  // namespace BIL
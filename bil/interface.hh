@@ -45,6 +45,9 @@ class DriverInterface {
 
   virtual void initStats(std::vector<SimpleSSD::Stats> &) = 0;
   virtual void getStats(std::vector<double> &) = 0;
+
+  // Functional mode skips host-side timing (used by preconditioning)
+  virtual void setFunctionalMode(bool) {}
 };
 
 }  // namespace BIL
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bil/kyber_scheduler.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/print.hh"
+
+namespace BIL {
+
+const char *DOMAIN_NAME[] = {"Read", "Write", "Discard", "Other"};
+const char *DOMAIN_PREFIX[] = {"bil.kyber.read", "bil.kyber.write",
+                               "bil.kyber.discard", "bil.kyber.other"};
+
+// Initial (and maximum) token count and batch size of each domain
+const uint64_t DOMAIN_DEPTH[] = {256, 128, 64, 16};
+const uint64_t DOMAIN_BATCH[] = {16, 8, 1, 1};
+
+const uint64_t DISCARD_LATENCY = 5000000000000;  // 5s
+const uint64_t TIMER_PERIOD = 100000000000;      // 100ms
+
+// Percentile is calculated with at least this many samples, or after
+// SAMPLE_TIMEOUT since first try
+const uint64_t MIN_SAMPLES = 500;
+const uint64_t SAMPLE_TIMEOUT = 1000000000000;  // 1s
+
+// Buckets below target latency
+const int32_t GOOD_BUCKETS = 4;
+const uint32_t LATENCY_SHIFT = 2;
+
+KyberScheduler::KyberScheduler(Engine &e, DriverInterface *i, ConfigReader &c)
+    : Scheduler(e, i), inflight(0), domain(DOMAIN_READ), batching(0) {
+  maxDepth = c.readUint(CONFIG_GLOBAL, GLOBAL_SCHEDULER_DEPTH);
+  target[DOMAIN_READ] = c.readUint(CONFIG_GLOBAL, GLOBAL_KYBER_READ_LATENCY);
+  target[DOMAIN_WRITE] = c.readUint(CONFIG_GLOBAL, GLOBAL_KYBER_WRITE_LATENCY);
+  target[DOMAIN_DISCARD] = DISCARD_LATENCY;
+  target[DOMAIN_OTHER] = 0;  // Not measured
+
+  for (uint32_t d = 0; d < DOMAIN_NUM; d++) {
+    depth[d] = DOMAIN_DEPTH[d];
+    domainInflight[d] = 0;
+    lastP99[d] = -1;
+
+    memset(window[d], 0, sizeof(window[d]));
+  }
+
+  timerEvent = engine.allocateEvent([this](uint64_t) { timer(); });
+
+  resetStats();
+}
+
+KyberScheduler::~KyberScheduler() {
+  engine.deallocateEvent(timerEvent);
+}
+
+void KyberScheduler::init() {}
+
+void KyberScheduler::submitIO(BIO &bio) {
+  uint64_t slot;
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = requestList.size();
+    requestList.emplace_back();
+  }
+
+  auto &req = requestList[slot];
+
+  req.bio = std::move(bio);
+  req.queuedAt = engine.getCurrentTick();
+
+  switch (req.bio.type) {
+    case BIO_READ:
+      req.domain = DOMAIN_READ;
+      break;
+    case BIO_WRITE:
+      req.domain = DOMAIN_WRITE;
+      break;
+    case BIO_TRIM:
+      req.domain = DOMAIN_DISCARD;
+      break;
+    default:
+      req.domain = DOMAIN_OTHER;
+      break;
+  }
+
+  queue[req.domain].push_back(slot);
+
+  run();
+}
+
+void KyberScheduler::run() {
+  while (inflight < maxDepth) {
+    bool found = batching < DOMAIN_BATCH[domain] && dispatchDomain();
+
+    // Move to next domain with pending BIO and token
+    if (!found) {
+      batching = 0;
+
+      for (uint32_t i = 0; i < DOMAIN_NUM && !found; i++) {
+        domain = (domain + 1) % DOMAIN_NUM;
+        found = dispatchDomain();
+      }
+    }
+
+    if (!found) {
+      break;
+    }
+  }
+}
+
+bool KyberScheduler::dispatchDomain() {
+  auto &list = queue[domain];
+
+  if (list.size() == 0) {
+    return false;
+  }
+  if (domainInflight[domain] >= depth[domain]) {
+    throttleCount[domain]++;
+
+    return false;
+  }
+
+  uint64_t slot = list.front();
+  auto &req = requestList[slot];
+  BIO bio;
+
+  list.pop_front();
+
+  // Callback is kept here and called on completion
+  bio.id = req.bio.id;
+  bio.type = req.bio.type;
+  bio.offset = req.bio.offset;
+  bio.length = req.bio.length;
+  bio.submittedAt = req.bio.submittedAt;
+  bio.breakdown = req.bio.breakdown;
+  bio.callback = [this, slot](uint64_t) { completion(slot); };
+
+  req.dispatchedAt = engine.getCurrentTick();
+
+  domainInflight[domain]++;
+  inflight++;
+  batching++;
+  dispatchCount[domain]++;
+
+  dispatch(bio);
+
+  return true;
+}
+
+void KyberScheduler::completion(uint64_t slot) {
+  uint64_t tick = engine.getCurrentTick();
+  auto &req = requestList[slot];
+
+  if (req.domain != DOMAIN_OTHER) {
+    addLatency(req.domain, LATENCY_TOTAL, tick - req.queuedAt);
+    addLatency(req.domain, LATENCY_IO, tick - req.dispatchedAt);
+  }
+
+  domainInflight[req.domain]--;
+  inflight--;
+
+  // Callback may submit new BIO, which may reuse this slot
+  uint64_t id = req.bio.id;
+  BIOFunction callback = std::move(req.bio.callback);
+
+  freeSlot.push_back(slot);
+
+  if (!engine.isScheduled(timerEvent)) {
+    engine.scheduleEvent(timerEvent, tick + TIMER_PERIOD);
+  }
+
+  callback(id);
+
+  run();
+}
+
+void KyberScheduler::addLatency(uint32_t d, LATENCY_TYPE type,
+                                uint64_t latency) {
+  uint64_t divisor = std::max(target[d] >> LATENCY_SHIFT, (uint64_t)1);
+  uint64_t bucket = latency > 0 ? (latency - 1) / divisor : 0;
+
+  window[d][type].bucket[std::min(bucket, (uint64_t)LATENCY_BUCKETS - 1)]++;
+}
+
+int32_t KyberScheduler::getPercentile(uint32_t d, LATENCY_TYPE type,
+                                      uint32_t percentile) {
+  uint64_t tick = engine.getCurrentTick();
+  auto &win = window[d][type];
+  uint64_t samples = 0;
+  uint32_t bucket;
+
+  for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    samples += win.bucket[bucket];
+  }
+
+  if (samples == 0) {
+    return -1;
+  }
+
+  // Wait for more samples
+  if (win.timeout == 0) {
+    win.timeout = tick + SAMPLE_TIMEOUT;
+  }
+  if (samples < MIN_SAMPLES && tick < win.timeout) {
+    return -1;
+  }
+
+  uint64_t rank = (samples * percentile + 99) / 100;
+
+  for (bucket = 0; bucket < LATENCY_BUCKETS - 1; bucket++) {
+    if (win.bucket[bucket] >= rank) {
+      break;
+    }
+
+    rank -= win.bucket[bucket];
+  }
+
+  memset(&win, 0, sizeof(LatencyWindow));
+
+  return (int32_t)bucket;
+}
+
+void KyberScheduler::resize(uint32_t d, uint64_t value) {
+  value = std::min(std::max(value, (uint64_t)1), DOMAIN_DEPTH[d]);
+
+  if (value == depth[d]) {
+    return;
+  }
+
+  if (value > depth[d]) {
+    raiseCount[d]++;
+  }
+  else {
+    lowerCount[d]++;
+  }
+
+  depth[d] = value;
+  minDepth[d] = std::min(minDepth[d], value);
+  intervalAdjust[d]++;
+}
+
+void KyberScheduler::timer() {
+  bool bad = false;
+
+  // Congested if any domain has high dispatch-to-completion latency
+  for (uint32_t d = 0; d < DOMAIN_OTHER; d++) {
+    if (getPercentile(d, LATENCY_IO, 90) >= GOOD_BUCKETS) {
+      bad = true;
+    }
+  }
+
+  if (bad) {
+    congestionCount++;
+  }
+
+  for (uint32_t d = 0; d < DOMAIN_OTHER; d++) {
+    int32_t p99 = getPercentile(d, LATENCY_TOTAL, 99);
+
+    // Domains may not have enough samples in same window, so p99 is kept
+    // until next congestion
+    if (bad) {
+      if (p99 < 0) {
+        p99 = lastP99[d];
+      }
+
+      lastP99[d] = -1;
+    }
+    else if (p99 >= 0) {
+      lastP99[d] = p99;
+    }
+
+    if (p99 < 0) {
+      continue;
+    }
+
+    // Throttle domains with good latency on congestion, and ease up on
+    // domains with bad latency. Depth is scaled by p99 / target.
+    if (bad || p99 >= GOOD_BUCKETS) {
+      resize(d, (depth[d] * (p99 + 1)) >> LATENCY_SHIFT);
+    }
+  }
+
+  // Tokens may be increased
+  run();
+}
+
+void KyberScheduler::printStats(std::ostream &out) {
+  out << "*** Statistics of Kyber Scheduler ***" << std::endl;
+  out << "Congested windows: " << congestionCount << std::endl;
+
+  for (uint32_t d = 0; d < DOMAIN_NUM; d++) {
+    out << DOMAIN_NAME[d] << " domain: dispatched " << dispatchCount[d]
+        << ", tokens " << depth[d] << " (min " << minDepth[d] << ", max "
+        << DOMAIN_DEPTH[d] << "), raised " << raiseCount[d] << ", lowered "
+        << lowerCount[d] << ", throttled " << throttleCount[d] << std::endl;
+  }
+
+  out << "*** End of statistics ***" << std::endl;
+}
+
+void KyberScheduler::resetStats() {
+  for (uint32_t d = 0; d < DOMAIN_NUM; d++) {
+    dispatchCount[d] = 0;
+    throttleCount[d] = 0;
+    raiseCount[d] = 0;
+    lowerCount[d] = 0;
+    minDepth[d] = depth[d];
+    intervalAdjust[d] = 0;
+  }
+
+  congestionCount = 0;
+}
+
+void KyberScheduler::printInterval(std::ostream &out) {
+  for (uint32_t d = 0; d < DOMAIN_OTHER; d++) {
+    std::string prefix(DOMAIN_PREFIX[d]);
+
+    print(out, prefix + ".tokens", 40);
+    out << "\t";
+    print(out, (double)depth[d], 20);
+    out << "\tToken count at end of interval" << std::endl;
+
+    print(out, prefix + ".adjust", 40);
+    out << "\t";
+    print(out, (double)intervalAdjust[d], 20);
+    out << "\tToken count adjustments in interval" << std::endl;
+
+    intervalAdjust[d] = 0;
+  }
+}
+
+}  // namespace BIL
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __BIL_KYBER_SCHEDULER__
+#define __BIL_KYBER_SCHEDULER__
+
+#include <deque>
+#include <vector>
+
+#include "bil/scheduler.hh"
+
+namespace BIL {
+
+// Same policy with Kyber of Linux
+// BIOs are dispatched round-robin over domains, and each domain can have
+// limited number of BIOs in driver (tokens). Every window, token count of
+// each domain is scaled by its p99 latency relative to target latency when
+// device looks congested (p90 of dispatch-to-completion latency is above
+// target in any domain).
+class KyberScheduler : public Scheduler {
+ private:
+  enum DOMAIN {
+    DOMAIN_READ,
+    DOMAIN_WRITE,
+    DOMAIN_DISCARD,  // Trim
+    DOMAIN_OTHER,    // Flush, token count is not adjusted
+    DOMAIN_NUM,
+  };
+
+  enum LATENCY_TYPE {
+    LATENCY_TOTAL,  // Submission to completion
+    LATENCY_IO,     // Dispatch to completion
+    LATENCY_TYPE_NUM,
+  };
+
+  // Bucket N holds latency in (N / 4, (N + 1) / 4] x target latency
+  static const uint32_t LATENCY_BUCKETS = 8;
+
+  typedef struct _Request {
+    BIO bio;
+    uint32_t domain;
+    uint64_t queuedAt;
+    uint64_t dispatchedAt;
+  } Request;
+
+  typedef struct _LatencyWindow {
+    uint64_t bucket[LATENCY_BUCKETS];
+    uint64_t timeout;  // Percentile with few samples is used after this
+  } LatencyWindow;
+
+  // Queued and dispatched BIOs, indexed by slot ID
+  std::vector<Request> requestList;
+  std::vector<uint64_t> freeSlot;
+
+  std::deque<uint64_t> queue[DOMAIN_NUM];
+
+  uint64_t maxDepth;  // BIOs in driver
+  uint64_t inflight;
+  uint64_t target[DOMAIN_NUM];
+
+  // Tokens
+  uint64_t depth[DOMAIN_NUM];
+  uint64_t domainInflight[DOMAIN_NUM];
+  uint32_t domain;    // Current domain of round-robin
+  uint64_t batching;  // BIOs dispatched from current domain
+
+  LatencyWindow window[DOMAIN_NUM][LATENCY_TYPE_NUM];
+  int32_t lastP99[DOMAIN_NUM];  // Kept until next congestion
+  SimpleSSD::Event timerEvent;
+
+  // Statistics
+  uint64_t dispatchCount[DOMAIN_NUM];
+  uint64_t throttleCount[DOMAIN_NUM];  // No token when BIO is pending
+  uint64_t raiseCount[DOMAIN_NUM];
+  uint64_t lowerCount[DOMAIN_NUM];
+  uint64_t minDepth[DOMAIN_NUM];
+  uint64_t congestionCount;
+  uint64_t intervalAdjust[DOMAIN_NUM];  // Reset by printInterval
+
+  void run();
+  bool dispatchDomain();
+  void completion(uint64_t);
+  void addLatency(uint32_t, LATENCY_TYPE, uint64_t);
+  int32_t getPercentile(uint32_t, LATENCY_TYPE, uint32_t);
+  void resize(uint32_t, uint64_t);
+  void timer();
+
+ public:
+  KyberScheduler(Engine &, DriverInterface *, ConfigReader &);
+  ~KyberScheduler();
+
+  void init() override;
+  void submitIO(BIO &) override;
+
+  void printStats(std::ostream &) override;
+  void resetStats() override;
+  void printInterval(std::ostream &) override;
+};
+
+}  // namespace BIL
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bil/latency_log.hh"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace BIL {
+
+const char LOG_MAGIC[8] = {'S', 'S', 'D', 'L', 'A', 'T', '0', '1'};
+
+// Must be power of two
+const uint64_t RING_SIZE = 65536;
+
+// Writer thread is woken up every BATCH_SIZE records
+const uint64_t BATCH_SIZE = RING_SIZE / 16;
+
+LatencyLog::LatencyLog(std::ostream &o, LOG_FORMAT f, uint64_t n)
+    : out(o),
+      format(f),
+      sampling(n),
+      sampleCount(0),
+      ring(RING_SIZE),
+      head(0),
+      tail(0),
+      stopping(false) {
+  if (format == LOG_FORMAT_BINARY) {
+    out.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+  }
+
+  resume();
+}
+
+LatencyLog::~LatencyLog() {
+  suspend();
+}
+
+void LatencyLog::write(uint64_t id, uint32_t type, uint64_t offset,
+                       uint64_t length, uint64_t submittedAt,
+                       uint64_t latency, const uint64_t *stage) {
+  if (sampling > 1 && sampleCount++ % sampling != 0) {
+    return;
+  }
+
+  uint64_t pos = head.load(std::memory_order_relaxed);
+
+  if (pos - tail.load(std::memory_order_acquire) == RING_SIZE) {
+    std::unique_lock<std::mutex> guard(lock);
+
+    spaceReady.wait(guard, [this, pos]() {
+      return pos - tail.load(std::memory_order_acquire) < RING_SIZE;
+    });
+  }
+
+  auto &record = ring[pos & (RING_SIZE - 1)];
+
+  record.id = id;
+  record.offset = offset;
+  record.length = length;
+  record.submittedAt = submittedAt;
+  record.latency = latency;
+  record.type = type;
+  record.stages = 0;
+
+  if (stage) {
+    record.stages = BREAKDOWN_NUM;
+
+    std::copy(stage, stage + BREAKDOWN_NUM, record.stage);
+  }
+
+  head.store(pos + 1, std::memory_order_release);
+
+  if ((pos + 1) % BATCH_SIZE == 0) {
+    // Lock prevents lost wake-up
+    { std::lock_guard<std::mutex> guard(lock); }
+
+    dataReady.notify_one();
+  }
+}
+
+void LatencyLog::writerFunc() {
+  std::vector<char> buffer;
+  bool done = false;
+
+  buffer.reserve(BATCH_SIZE * LOG_CSV_LENGTH);
+
+  while (!done) {
+    uint64_t begin = tail.load(std::memory_order_relaxed);
+    uint64_t end;
+
+    {
+      std::unique_lock<std::mutex> guard(lock);
+
+      dataReady.wait(guard, [this, begin]() {
+        return stopping ||
+               head.load(std::memory_order_acquire) - begin >= BATCH_SIZE;
+      });
+
+      // Write all remaining records before exit
+      done = stopping;
+    }
+
+    end = head.load(std::memory_order_acquire);
+
+    for (uint64_t i = begin; i < end; i++) {
+      auto &record = ring[i & (RING_SIZE - 1)];
+
+      if (format == LOG_FORMAT_BINARY) {
+        const char *ptr = (const char *)&record;
+
+        buffer.insert(buffer.end(), ptr,
+                      ptr + LOG_RECORD_BASE + record.stages * sizeof(uint64_t));
+      }
+      else {
+        char line[LOG_CSV_LENGTH];
+
+        buffer.insert(buffer.end(), line, line + formatCSV(line, record));
+      }
+
+      // Release space periodically while formatting
+      if (buffer.size() >= BATCH_SIZE * sizeof(LatencyRecord)) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+        tail.store(i + 1, std::memory_order_release);
+
+        { std::lock_guard<std::mutex> guard(lock); }
+
+        spaceReady.notify_one();
+      }
+    }
+
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+    tail.store(end, std::memory_order_release);
+
+    { std::lock_guard<std::mutex> guard(lock); }
+
+    spaceReady.notify_one();
+  }
+
+  out.flush();
+}
+
+void LatencyLog::suspend() {
+  if (!writer.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    stopping = true;
+  }
+
+  dataReady.notify_one();
+  writer.join();
+}
+
+void LatencyLog::resume() {
+  if (writer.joinable()) {
+    return;
+  }
+
+  stopping = false;
+  writer = std::thread([this]() { writerFunc(); });
+}
+
+void LatencyLog::restart() {
+  sampleCount = 0;
+
+  if (format == LOG_FORMAT_BINARY) {
+    out.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+  }
+
+  resume();
+}
+
+uint32_t LatencyLog::formatCSV(char *line, LatencyRecord &record) {
+  // Same column order with previous latency log, followed by new columns
+  int ret = snprintf(line, LOG_CSV_LENGTH,
+                     "%" PRIu64 ", %" PRIu64 ", %" PRIu64 ", %" PRIu64
+                     ", %" PRIu32 ", %" PRIu64,
+                     record.id, record.offset, record.length, record.latency,
+                     record.type, record.submittedAt);
+  uint32_t length = ret > 0 ? (uint32_t)ret : 0;
+
+  // Stage not crossed by I/O is left empty
+  for (uint32_t i = 0; i < record.stages && i < BREAKDOWN_NUM; i++) {
+    if (record.stage[i] == NO_STAMP) {
+      ret = snprintf(line + length, LOG_CSV_LENGTH - length, ", ");
+    }
+    else {
+      ret = snprintf(line + length, LOG_CSV_LENGTH - length, ", %" PRIu64,
+                     record.stage[i]);
+    }
+
+    length += ret > 0 ? (uint32_t)ret : 0;
+  }
+
+  line[length++] = '\n';
+
+  return length;
+}
+
+}  // namespace BIL
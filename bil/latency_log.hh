@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __BIL_LATENCY_LOG__
+#define __BIL_LATENCY_LOG__
+
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bil/breakdown.hh"
+
+namespace BIL {
+
+typedef enum {
+  LOG_FORMAT_CSV,
+  LOG_FORMAT_BINARY,
+  LOG_FORMAT_NUM,
+} LOG_FORMAT;
+
+// Binary record in host byte order, after 8 byte header LOG_MAGIC
+// Only first `stages` entries of stage are written to binary log.
+typedef struct _LatencyRecord {
+  uint64_t id;
+  uint64_t offset;
+  uint64_t length;
+  uint64_t submittedAt;
+  uint64_t latency;
+  uint32_t type;    // BIO_TYPE
+  uint32_t stages;  // 0 or BREAKDOWN_NUM (LatencyBreakdown = 1)
+  uint64_t stage[BREAKDOWN_NUM];
+} LatencyRecord;
+
+// Size of record without breakdown
+const size_t LOG_RECORD_BASE = offsetof(LatencyRecord, stage);
+
+extern const char LOG_MAGIC[8];
+
+// Maximum length of one CSV line
+const uint32_t LOG_CSV_LENGTH = 320;
+
+// Asynchronous latency log
+// Simulation thread puts records into ring buffer, and writer thread formats
+// and writes them in large chunks. Simulation thread blocks only when ring
+// buffer is full.
+class LatencyLog {
+ private:
+  std::ostream &out;
+  LOG_FORMAT format;
+  uint64_t sampling;  // Log 1 of N records
+  uint64_t sampleCount;
+
+  // Single producer, single consumer ring buffer
+  std::vector<LatencyRecord> ring;
+  std::atomic<uint64_t> head;  // Written by simulation thread
+  std::atomic<uint64_t> tail;  // Written by writer thread
+
+  std::thread writer;
+  std::mutex lock;
+  std::condition_variable dataReady;
+  std::condition_variable spaceReady;
+  bool stopping;
+
+  void writerFunc();
+
+ public:
+  LatencyLog(std::ostream &, LOG_FORMAT, uint64_t);
+  ~LatencyLog();
+
+  // Stage latencies (BREAKDOWN_NUM entries) are optional
+  void write(uint64_t, uint32_t, uint64_t, uint64_t, uint64_t, uint64_t,
+             const uint64_t * = nullptr);
+
+  // Writer thread is not duplicated by fork
+  // Suspend writes all buffered records before fork
+  void suspend();
+  void resume();
+
+  // Start new log after output stream is reopened while suspended
+  void restart();
+
+  // Returns length of line including newline
+  static uint32_t formatCSV(char *, LatencyRecord &);
+};
+
+}  // namespace BIL
+
+#endif
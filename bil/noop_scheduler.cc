@@ -28,7 +28,7 @@ NoopScheduler::~NoopScheduler() {}
 void NoopScheduler::init() {}
 
 void NoopScheduler::submitIO(BIO &bio) {
-  pInterface->submitIO(bio);
+  dispatch(bio);
 }
 
 }  // namespace BIL
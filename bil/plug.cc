@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bil/plug.hh"
+
+namespace BIL {
+
+// Plug is flushed at this many requests (BLK_MAX_REQUEST_COUNT of Linux)
+const uint64_t PLUG_MAX_COUNT = 32;
+
+Plug::Plug(Engine &e, Scheduler *s, ConfigReader &c)
+    : engine(e), pScheduler(s) {
+  window = c.readUint(CONFIG_GLOBAL, GLOBAL_PLUG_WINDOW);
+  maxSize = c.readUint(CONFIG_GLOBAL, GLOBAL_MAX_REQUEST_SIZE);
+
+  unplugEvent = engine.allocateEvent([this](uint64_t) {
+    timerUnplugCount++;
+    unplug();
+  });
+
+  resetStats();
+}
+
+Plug::~Plug() {
+  engine.deallocateEvent(unplugEvent);
+}
+
+void Plug::submitIO(BIO &bio) {
+  uint64_t slot;
+
+  bioCount++;
+
+  // Only reads and writes are merged. Others are not reordered with
+  // plugged BIOs.
+  if (bio.type != BIO_READ && bio.type != BIO_WRITE) {
+    if (plugList.size() > 0) {
+      forcedUnplugCount++;
+      unplug();
+    }
+
+    requestCount++;
+    requestBytes += bio.length;
+    pScheduler->submitIO(bio);
+
+    return;
+  }
+
+  if (merge(bio)) {
+    return;
+  }
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = requestList.size();
+    requestList.emplace_back();
+  }
+
+  auto &req = requestList[slot];
+
+  req.bio.id = bio.id;
+  req.bio.type = bio.type;
+  req.bio.offset = bio.offset;
+  req.bio.length = bio.length;
+  req.bio.submittedAt = bio.submittedAt;
+  req.bio.breakdown = bio.breakdown;
+  req.memberList.push_back({bio.id, std::move(bio.callback), bio.breakdown});
+
+  beginMap[bio.type][bio.offset] = slot;
+  endMap[bio.type][bio.offset + bio.length] = slot;
+  plugList.push_back(slot);
+
+  if (plugList.size() == 1) {
+    engine.scheduleEvent(unplugEvent, engine.getCurrentTick() + window);
+  }
+  else if (plugList.size() >= PLUG_MAX_COUNT) {
+    forcedUnplugCount++;
+    unplug();
+  }
+}
+
+bool Plug::merge(BIO &bio) {
+  auto &beginList = beginMap[bio.type];
+  auto &endList = endMap[bio.type];
+
+  // Back merge: plugged request ends where BIO begins
+  auto iter = endList.find(bio.offset);
+
+  if (iter != endList.end()) {
+    uint64_t slot = iter->second;
+    auto &req = requestList[slot];
+
+    if (req.bio.length + bio.length <= maxSize) {
+      endList.erase(iter);
+
+      req.bio.length += bio.length;
+      req.memberList.push_back(
+          {bio.id, std::move(bio.callback), bio.breakdown});
+      endList[req.bio.offset + req.bio.length] = slot;
+      backMergeCount++;
+
+      return true;
+    }
+  }
+
+  // Front merge: plugged request begins where BIO ends
+  iter = beginList.find(bio.offset + bio.length);
+
+  if (iter != beginList.end()) {
+    uint64_t slot = iter->second;
+    auto &req = requestList[slot];
+
+    if (req.bio.length + bio.length <= maxSize) {
+      beginList.erase(iter);
+
+      req.bio.offset = bio.offset;
+      req.bio.length += bio.length;
+      req.memberList.push_back(
+          {bio.id, std::move(bio.callback), bio.breakdown});
+      beginList[req.bio.offset] = slot;
+      frontMergeCount++;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void Plug::unplug() {
+  std::vector<uint64_t> list;
+
+  list.swap(plugList);
+
+  for (uint32_t i = 0; i < 2; i++) {
+    beginMap[i].clear();
+    endMap[i].clear();
+  }
+
+  engine.descheduleEvent(unplugEvent);
+
+  for (auto slot : list) {
+    auto &req = requestList[slot];
+    BIO bio;
+
+    bio.id = req.bio.id;
+    bio.type = req.bio.type;
+    bio.offset = req.bio.offset;
+    bio.length = req.bio.length;
+    bio.submittedAt = req.bio.submittedAt;
+    bio.breakdown = req.bio.breakdown;
+    bio.callback = [this, slot](uint64_t) { completion(slot); };
+
+    requestCount++;
+    requestBytes += bio.length;
+
+    pScheduler->submitIO(bio);
+  }
+}
+
+void Plug::completion(uint64_t slot) {
+  auto &req = requestList[slot];
+  Breakdown *leader = req.bio.breakdown;
+  std::vector<Member> list;
+
+  // Callback may submit new BIO, which may reuse this slot
+  list.swap(req.memberList);
+  freeSlot.push_back(slot);
+
+  // Lower layers only stamped first BIO of request. Copy before callbacks,
+  // as completed BIO may be reused by block I/O entry.
+  if (leader) {
+    for (auto &member : list) {
+      if (member.breakdown && member.breakdown != leader) {
+        std::copy(leader->tick + STAGE_DISPATCH,
+                  leader->tick + STAGE_INTERRUPT + 1,
+                  member.breakdown->tick + STAGE_DISPATCH);
+      }
+    }
+  }
+
+  for (auto &member : list) {
+    member.callback(member.id);
+  }
+}
+
+void Plug::printStats(std::ostream &out) {
+  out << "*** Statistics of Plug ***" << std::endl;
+  out << "BIO (counts): " << bioCount << ", Request (counts): " << requestCount
+      << " (Average size: "
+      << std::to_string(requestCount > 0 ? (double)requestBytes / requestCount
+                                         : 0.)
+      << " bytes)" << std::endl;
+  out << "Merged BIO (counts): Back: " << backMergeCount
+      << ", Front: " << frontMergeCount << std::endl;
+  out << "Unplug (counts): Timer: " << timerUnplugCount
+      << ", Forced: " << forcedUnplugCount << std::endl;
+  out << "*** End of statistics ***" << std::endl;
+}
+
+void Plug::resetStats() {
+  bioCount = 0;
+  requestCount = 0;
+  requestBytes = 0;
+  backMergeCount = 0;
+  frontMergeCount = 0;
+  timerUnplugCount = 0;
+  forcedUnplugCount = 0;
+}
+
+}  // namespace BIL
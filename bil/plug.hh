@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __BIL_PLUG__
+#define __BIL_PLUG__
+
+#include <unordered_map>
+#include <vector>
+
+#include "bil/scheduler.hh"
+
+namespace BIL {
+
+// Holds BIOs for plug window before passing them to scheduler, and merges
+// contiguous BIOs of same type into one request (front and back merge).
+// Completion of merged request completes all BIOs in it.
+class Plug {
+ private:
+  typedef struct _Member {
+    uint64_t id;
+    BIOFunction callback;
+    Breakdown *breakdown;
+  } Member;
+
+  typedef struct _Request {
+    BIO bio;  // Merged
+    std::vector<Member> memberList;
+  } Request;
+
+  Engine &engine;
+  Scheduler *pScheduler;
+
+  uint64_t window;
+  uint64_t maxSize;
+
+  // Plugged and dispatched requests, indexed by slot ID
+  std::vector<Request> requestList;
+  std::vector<uint64_t> freeSlot;
+
+  // Plugged requests in submission order
+  std::vector<uint64_t> plugList;
+  // Offset to plugged request, indexed by BIO_READ and BIO_WRITE
+  std::unordered_map<uint64_t, uint64_t> beginMap[2];
+  std::unordered_map<uint64_t, uint64_t> endMap[2];
+  SimpleSSD::Event unplugEvent;
+
+  // Statistics
+  uint64_t bioCount;
+  uint64_t requestCount;
+  uint64_t requestBytes;
+  uint64_t backMergeCount;
+  uint64_t frontMergeCount;
+  uint64_t timerUnplugCount;
+  uint64_t forcedUnplugCount;  // By plug size or unmergeable BIO
+
+  bool merge(BIO &);
+  void unplug();
+  void completion(uint64_t);
+
+ public:
+  Plug(Engine &, Scheduler *, ConfigReader &);
+  ~Plug();
+
+  void submitIO(BIO &);
+
+  void printStats(std::ostream &);
+  void resetStats();
+};
+
+}  // namespace BIL
+
+#endif
@@ -31,12 +31,27 @@ class Scheduler {
   Engine &engine;
   DriverInterface *pInterface;
 
+  // Passes BIO to driver
+  void dispatch(BIO &bio) {
+    if (bio.breakdown) {
+      bio.breakdown->tick[STAGE_DISPATCH] = engine.getCurrentTick();
+    }
+
+    pInterface->submitIO(bio);
+  }
+
  public:
   Scheduler(Engine &e, DriverInterface *i) : engine(e), pInterface(i) {}
   virtual ~Scheduler() {}
 
   virtual void init() = 0;
   virtual void submitIO(BIO &) = 0;
+
+  virtual void printStats(std::ostream &) {}
+  virtual void resetStats() {}
+
+  // Called with periodic statistic log
+  virtual void printInterval(std::ostream &) {}
 };
 
 }  // namespace BIL
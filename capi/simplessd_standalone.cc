@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capi/simplessd_standalone.h"
+
+#include <deque>
+
+#include "sim/simulation.hh"
+#include "simplessd/sim/trace.hh"
+
+struct _simplessd_sim {
+  Simulation simulation;
+  std::deque<simplessd_completion> completionQueue;
+
+  bool configured;
+  bool ready;       // Driver initialized
+  uint64_t nextID;  // BIO ID should be unique among on-the-fly I/Os
+
+  _simplessd_sim() : configured(false), ready(false), nextID(0) {}
+};
+
+simplessd_sim *simplessd_create(void) {
+  return new simplessd_sim();
+}
+
+void simplessd_destroy(simplessd_sim *sim) {
+  delete sim;
+}
+
+int simplessd_configure(simplessd_sim *sim, const char *simConfig,
+                        const char *ssdConfig) {
+  if (sim->configured) {
+    return -1;
+  }
+  if (!sim->simulation.getConfig().init(simConfig)) {
+    return -2;
+  }
+
+  sim->configured = true;
+
+  if (!sim->simulation.init(ssdConfig)) {
+    return -3;
+  }
+
+  // Run until driver finishes initialization
+  std::function<void()> beginCallback = [sim]() { sim->ready = true; };
+  auto &engine = sim->simulation.getEngine();
+
+  sim->simulation.getInterface().init(beginCallback);
+
+  while (!sim->ready && engine.doNextBatch())
+    ;
+
+  return sim->ready ? 0 : -4;
+}
+
+void simplessd_get_info(simplessd_sim *sim, uint64_t *bytesize,
+                        uint32_t *lbasize) {
+  sim->simulation.activate();
+  sim->simulation.getInterface().getInfo(*bytesize, *lbasize);
+}
+
+void simplessd_submit(simplessd_sim *sim, const simplessd_io *list,
+                      size_t count) {
+  if (!sim->ready) {
+    SimpleSSD::panic("Simulation is not configured");
+  }
+
+  auto &engine = sim->simulation.getEngine();
+  auto &bioEntry = sim->simulation.getBlockIO();
+
+  sim->simulation.activate();
+
+  for (size_t i = 0; i < count; i++) {
+    BIL::BIO bio;
+    uint64_t id = list[i].id;
+    uint64_t tick = engine.getCurrentTick();
+
+    if (list[i].type >= BIL::BIO_NUM) {
+      SimpleSSD::panic("Invalid I/O type %u", list[i].type);
+    }
+
+    bio.id = sim->nextID++;
+    bio.type = (BIL::BIO_TYPE)list[i].type;
+    bio.offset = list[i].offset;
+    bio.length = list[i].length;
+    bio.submittedAt = tick;
+    bio.callback = [sim, id, tick](uint64_t) {
+      uint64_t now = sim->simulation.getEngine().getCurrentTick();
+
+      sim->completionQueue.push_back({id, now, now - tick});
+    };
+
+    bioEntry.submitIO(bio);
+  }
+}
+
+uint64_t simplessd_advance(simplessd_sim *sim, uint64_t tick) {
+  if (!sim->ready) {
+    SimpleSSD::panic("Simulation is not configured");
+  }
+
+  return sim->simulation.advance(tick);
+}
+
+uint64_t simplessd_get_tick(simplessd_sim *sim) {
+  return sim->ready ? sim->simulation.getEngine().getCurrentTick() : 0;
+}
+
+size_t simplessd_poll(simplessd_sim *sim, simplessd_completion *list,
+                      size_t count) {
+  size_t i = 0;
+
+  for (; i < count && sim->completionQueue.size() > 0; i++) {
+    list[i] = sim->completionQueue.front();
+    sim->completionQueue.pop_front();
+  }
+
+  return i;
+}
+
+size_t simplessd_get_stat_count(simplessd_sim *sim) {
+  return sim->simulation.getStatList().size();
+}
+
+const char *simplessd_get_stat_name(simplessd_sim *sim, size_t idx) {
+  auto &statList = sim->simulation.getStatList();
+
+  return idx < statList.size() ? statList[idx].name.c_str() : nullptr;
+}
+
+size_t simplessd_get_stats(simplessd_sim *sim, double *values, size_t count) {
+  std::vector<double> stat;
+
+  if (!sim->ready) {
+    return 0;
+  }
+
+  sim->simulation.activate();
+  sim->simulation.getInterface().getStats(stat);
+
+  for (size_t i = 0; i < count && i < stat.size(); i++) {
+    values[i] = stat[i];
+  }
+
+  return stat.size();
+}
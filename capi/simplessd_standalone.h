@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __CAPI_SIMPLESSD_STANDALONE__
+#define __CAPI_SIMPLESSD_STANDALONE__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C API of SimpleSSD-Standalone library
+//
+// Each handle is one simulated host and SSD with its own event engine.
+// Handles can be interleaved in one thread, but SimpleSSD has process-wide
+// state, so do not call the API from multiple threads concurrently.
+// SimpleSSD CPU model is also process-wide. It is configured by the first
+// handle, and firmware of all handles runs on the same cores, so cpu.*
+// statistics of each handle cover all handles. Configuring a handle whose
+// [cpu] section differs from the first handle fails. Run independent SSDs
+// in separate processes (or multi-device mode, DeviceCount > 1).
+// Time is in picoseconds. Invalid configuration terminates the process, as
+// the executable does.
+
+typedef struct _simplessd_sim simplessd_sim;
+
+typedef enum {
+  SIMPLESSD_IO_READ,
+  SIMPLESSD_IO_WRITE,
+  SIMPLESSD_IO_FLUSH,
+  SIMPLESSD_IO_TRIM,
+} simplessd_io_type;
+
+typedef struct {
+  uint64_t id;      // Returned in completion
+  uint32_t type;    // simplessd_io_type
+  uint64_t offset;  // In bytes
+  uint64_t length;  // In bytes
+} simplessd_io;
+
+typedef struct {
+  uint64_t id;
+  uint64_t tick;     // Completed at
+  uint64_t latency;  // Completed at - submitted at
+} simplessd_completion;
+
+simplessd_sim *simplessd_create(void);
+void simplessd_destroy(simplessd_sim *);
+
+// Read simulation and SimpleSSD configuration files, and initialize SSD
+// Returns 0 on success, non-zero if interface is invalid or [cpu] section
+// conflicts with other handle
+int simplessd_configure(simplessd_sim *, const char *, const char *);
+
+// Capacity in bytes and logical block size in bytes
+void simplessd_get_info(simplessd_sim *, uint64_t *, uint32_t *);
+
+// Submit I/Os at current tick
+void simplessd_submit(simplessd_sim *, const simplessd_io *, size_t);
+
+// Run simulation until given tick, and returns current tick
+uint64_t simplessd_advance(simplessd_sim *, uint64_t);
+uint64_t simplessd_get_tick(simplessd_sim *);
+
+// Pop up to given number of completions, and returns popped count
+size_t simplessd_poll(simplessd_sim *, simplessd_completion *, size_t);
+
+// Statistics of SSD
+size_t simplessd_get_stat_count(simplessd_sim *);
+const char *simplessd_get_stat_name(simplessd_sim *, size_t);
+size_t simplessd_get_stats(simplessd_sim *, double *, size_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
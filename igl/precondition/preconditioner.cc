@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "igl/precondition/preconditioner.hh"
+
+#include "simplessd/sim/trace.hh"
+#include "simplessd/util/algorithm.hh"
+
+// Sequential fill uses large request to reduce number of I/O
+#define FILL_BLOCK_SIZE 1048576
+
+namespace IGL {
+
+Preconditioner::Preconditioner(Engine &e, BIL::BlockIOEntry &b,
+                               std::function<void()> &f, ConfigReader &c)
+    : IOGenerator(e, b, f),
+      ssdSize(0),
+      fillSize(0),
+      randomSize(0),
+      io_submitted(0),
+      io_count(0),
+      io_depth(0),
+      initTime(0),
+      reserveTermination(false) {
+  fillRatio = c.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_FILL);
+  randomRatio = c.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_RANDOM);
+  blocksize = c.readUint(CONFIG_GLOBAL, GLOBAL_PRECONDITION_BLOCK_SIZE);
+  iodepth = c.readUint(CONFIG_GLOBAL, GLOBAL_PRECONDITION_DEPTH);
+
+  submitEvent = engine.allocateEvent([this](uint64_t) { submitIO(); });
+}
+
+Preconditioner::~Preconditioner() {
+  engine.deallocateEvent(submitEvent);
+}
+
+void Preconditioner::init(uint64_t bytesize, uint32_t bs) {
+  if (blocksize < bs || blocksize % bs != 0) {
+    SimpleSSD::panic("Precondition block size is not aligned to SSD's "
+                     "logical block");
+  }
+  if (blocksize > bytesize) {
+    SimpleSSD::panic("Precondition block size is larger than SSD size");
+  }
+
+  ssdSize = bytesize;
+  fillSize = (uint64_t)(fillRatio * bytesize);
+  randomSize = (uint64_t)(randomRatio * bytesize);
+
+  // Align to block
+  fillSize = fillSize / bs * bs;
+  randomSize = randomSize / blocksize * blocksize;
+}
+
+void Preconditioner::begin() {
+  initTime = engine.getCurrentTick();
+
+  if (fillSize + randomSize == 0) {
+    reserveTermination = true;
+
+    endCallback();
+
+    return;
+  }
+
+  submitIO();
+}
+
+void Preconditioner::printStats(std::ostream &out) {
+  uint64_t tick = engine.getCurrentTick();
+
+  out << "*** Statistics of Preconditioner ***" << std::endl;
+  out << "Time (ps): " << initTime << " - " << tick << " (" << tick - initTime
+      << ")" << std::endl;
+  out << "Sequential write (bytes): " << MIN(io_submitted, fillSize)
+      << std::endl;
+  out << "Random write (bytes): "
+      << (io_submitted > fillSize ? io_submitted - fillSize : 0) << std::endl;
+  out << "I/O (counts): " << io_count << std::endl;
+  out << "*** End of statistics ***" << std::endl;
+}
+
+void Preconditioner::submitIO() {
+  // Fill I/O queue without submission latency
+  while (io_depth < iodepth && io_submitted < fillSize + randomSize) {
+    BIL::BIO bio;
+
+    if (io_submitted < fillSize) {
+      bio.offset = io_submitted % ssdSize;
+      bio.length = MIN(FILL_BLOCK_SIZE, fillSize - io_submitted);
+      bio.length = MIN(bio.length, ssdSize - bio.offset);
+    }
+    else {
+      bio.offset = randengine() % (ssdSize / blocksize) * blocksize;
+      bio.length = blocksize;
+    }
+
+    bio.id = io_count++;
+    bio.type = BIL::BIO_WRITE;
+    bio.callback = [this](uint64_t id) { iocallback(id); };
+    bio.submittedAt = engine.getCurrentTick();
+
+    io_submitted += bio.length;
+    io_depth++;
+
+    engine.getTelemetry().progress =
+        (double)io_submitted / (fillSize + randomSize);
+
+    bioEntry.submitIO(bio);
+  }
+
+  if (io_submitted >= fillSize + randomSize) {
+    reserveTermination = true;
+  }
+}
+
+void Preconditioner::iocallback(uint64_t) {
+  io_depth--;
+
+  if (reserveTermination) {
+    if (io_depth == 0) {
+      endCallback();
+    }
+  }
+  else if (!engine.isScheduled(submitEvent)) {
+    engine.scheduleEvent(submitEvent, engine.getCurrentTick());
+  }
+}
+
+}  // namespace IGL
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __IGL_PRECONDITIONER__
+#define __IGL_PRECONDITIONER__
+
+#include <random>
+
+#include "bil/entry.hh"
+#include "igl/io_gen.hh"
+#include "sim/cfg_reader.hh"
+#include "sim/engine.hh"
+
+namespace IGL {
+
+// Fast-forward workload to bring SSD to steady state
+// Writes whole SSD sequentially, then overwrites random blocks, without
+// host-side latency. Should be used with functional mode of driver.
+class Preconditioner : public IOGenerator {
+ private:
+  float fillRatio;
+  float randomRatio;
+  uint64_t blocksize;
+  uint64_t iodepth;
+
+  uint64_t ssdSize;
+  uint64_t fillSize;    // Bytes to write sequentially
+  uint64_t randomSize;  // Bytes to write randomly
+
+  uint64_t io_submitted;
+  uint64_t io_count;
+  uint64_t io_depth;
+
+  uint64_t initTime;
+  bool reserveTermination;
+
+  std::mt19937_64 randengine;
+
+  SimpleSSD::Event submitEvent;
+
+  void submitIO();
+  void iocallback(uint64_t);
+
+ public:
+  Preconditioner(Engine &, BIL::BlockIOEntry &, std::function<void()> &,
+                 ConfigReader &);
+  ~Preconditioner();
+
+  void init(uint64_t, uint32_t) override;
+  void begin() override;
+  void printStats(std::ostream &) override;
+};
+
+}  // namespace IGL
+
+#endif
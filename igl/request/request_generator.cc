@@ -64,13 +64,13 @@ RequestGenerator::RequestGenerator(Engine &e, BIL::BlockIOEntry &b,
   // Set random engine
   randengine.seed(randseed);
 
-  submitIO = [this](uint64_t tick) { _submitIO(tick); };
-  iocallback = [this](uint64_t id) { _iocallback(id); };
-
-  submitEvent = engine.allocateEvent(submitIO);
+  submitEvent =
+      engine.allocateEvent([this](uint64_t tick) { _submitIO(tick); });
 }
 
-RequestGenerator::~RequestGenerator() {}
+RequestGenerator::~RequestGenerator() {
+  engine.deallocateEvent(submitEvent);
+}
 
 void RequestGenerator::init(uint64_t bytesize, uint32_t bs) {
   if (offset > bytesize) {
@@ -134,36 +134,6 @@ void RequestGenerator::printStats(std::ostream &out) {
   bioEntry.printStats(out);
 }
 
-void RequestGenerator::getProgress(float &val) {
-  bool zero = false;
-
-  {
-    std::lock_guard<std::mutex> guard(m);
-
-    if (io_submitted == 0) {
-      zero = true;
-    }
-  }
-
-  if (zero) {
-    val = 0.f;
-
-    return;
-  }
-
-  if (time_based) {                           // Read-only variable after init
-    uint64_t tick = engine.getCurrentTick();  // Thread-safe
-
-    // initTime is read-only after begin() called
-    val = (float)(tick - initTime) / runtime;
-  }
-  else {
-    std::lock_guard<std::mutex> guard(m);
-
-    val = (float)io_submitted / io_size;
-  }
-}
-
 void RequestGenerator::generateAddress(uint64_t &off, uint64_t &len) {
   // This function generates address to access
   // based on I/O type, blocksize/align and offset/size
@@ -207,7 +177,7 @@ bool RequestGenerator::nextIOIsRead() {
   return false;
 }
 
-void RequestGenerator::_submitIO(uint64_t) {
+void RequestGenerator::_submitIO(uint64_t tick) {
   BIL::BIO bio;
 
   // This function uses io_count (=0 at very beginning)
@@ -226,7 +196,15 @@ void RequestGenerator::_submitIO(uint64_t) {
 
   io_submitted += bio.length;
 
-  bio.callback = iocallback;
+  if (time_based) {
+    engine.getTelemetry().progress = (double)(tick - initTime) / runtime;
+  }
+  else {
+    engine.getTelemetry().progress = (double)io_submitted / io_size;
+  }
+
+  bio.callback = [this](uint64_t id) { _iocallback(id); };
+  bio.submittedAt = tick;
 
   // push to queue
   io_depth++;
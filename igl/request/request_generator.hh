@@ -23,9 +23,7 @@
 #define __IGL_REQUEST_GENERATOR__
 
 #include <list>
-#include <mutex>
 #include <random>
-#include <thread>
 
 #include "bil/entry.hh"
 #include "igl/io_gen.hh"
@@ -36,8 +34,6 @@ namespace IGL {
 
 class RequestGenerator : public IOGenerator {
  private:
-  std::mutex m;
-
   uint64_t io_size;
   uint64_t io_submitted;
 
@@ -78,8 +74,6 @@ class RequestGenerator : public IOGenerator {
   void rescheduleSubmit(uint64_t);
 
   SimpleSSD::Event submitEvent;
-  SimpleSSD::EventFunction submitIO;
-  SimpleSSD::EventFunction iocallback;
 
   void _submitIO(uint64_t);
   void _iocallback(uint64_t);
@@ -92,7 +86,6 @@ class RequestGenerator : public IOGenerator {
   void init(uint64_t, uint32_t) override;
   void begin() override;
   void printStats(std::ostream &) override;
-  void getProgress(float &) override;
 };
 
 }  // namespace IGL
@@ -40,6 +40,8 @@ const char NAME_GROUP_NANO_SEC[] = "Nanosecond";
 const char NAME_GROUP_PICO_SEC[] = "Picosecond";
 const char NAME_LBA_SIZE[] = "LBASize";
 const char NAME_USE_HEX[] = "UseHexadecimal";
+const char NAME_SHARD_COUNT[] = "ShardCount";
+const char NAME_SHARD_WARMUP[] = "ShardWarmup";
 
 TraceConfig::TraceConfig() {
   mode = MODE_SYNC;
@@ -57,6 +59,8 @@ TraceConfig::TraceConfig() {
   groupPicoSecond = 0;
   lbaSize = 512;
   useHexadecimal = false;
+  shardCount = 1;
+  shardWarmup = 10000;
 }
 
 bool TraceConfig::setConfig(const char *name, const char *value) {
@@ -113,6 +117,12 @@ bool TraceConfig::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_USE_HEX)) {
     useHexadecimal = convertBool(value);
   }
+  else if (MATCH_NAME(NAME_SHARD_COUNT)) {
+    shardCount = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SHARD_WARMUP)) {
+    shardWarmup = strtoul(value, nullptr, 10);
+  }
   else {
     ret = false;
   }
@@ -152,6 +162,9 @@ void TraceConfig::update() {
   if (mode >= MODE_NUM) {
     SimpleSSD::panic("Invalid timing mode specified");
   }
+  if (shardCount == 0) {
+    SimpleSSD::panic("Invalid shard count specified");
+  }
 }
 
 uint64_t TraceConfig::readUint(uint32_t idx) {
@@ -200,6 +213,12 @@ uint64_t TraceConfig::readUint(uint32_t idx) {
     case TRACE_LBA_SIZE:
       ret = lbaSize;
       break;
+    case TRACE_SHARD_COUNT:
+      ret = shardCount;
+      break;
+    case TRACE_SHARD_WARMUP:
+      ret = shardWarmup;
+      break;
   }
 
   return ret;
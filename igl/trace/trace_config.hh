@@ -44,6 +44,8 @@ typedef enum {
   TRACE_GROUP_PICO_SEC,
   TRACE_LBA_SIZE,
   TRACE_USE_HEX,
+  TRACE_SHARD_COUNT,
+  TRACE_SHARD_WARMUP,
 } TRACE_CONFIG;
 
 typedef enum {
@@ -72,6 +74,8 @@ class TraceConfig : public SimpleSSD::BaseConfig {
   uint32_t groupPicoSecond;
   uint32_t lbaSize;
   bool useHexadecimal;
+  uint64_t shardCount;
+  uint64_t shardWarmup;
 
  public:
   TraceConfig();
@@ -27,6 +27,17 @@ namespace IGL {
 TraceReplayer::TraceReplayer(Engine &e, BIL::BlockIOEntry &b,
                              std::function<void()> &f, ConfigReader &c)
     : IOGenerator(e, b, f),
+      file(nullptr),
+      consumed(0),
+      firstByte(0),
+      shardBegin(0),
+      shardEnd(0),
+      measuring(true),
+      pendingReset(false),
+      measureTick(0),
+      baseCount(0),
+      baseRead(0),
+      baseWrite(0),
       useLBAOffset(false),
       useLBALength(false),
       nextIOIsSync(false),
@@ -38,9 +49,17 @@ TraceReplayer::TraceReplayer(Engine &e, BIL::BlockIOEntry &b,
       io_depth(0) {
   // Check file
   auto filename = c.readString(CONFIG_TRACE, TRACE_FILE);
-  file.open(filename);
+  const char *data;
+  uint64_t length;
 
-  if (!file.is_open()) {
+  if (findMappedFile(filename, data, length)) {
+    memoryBuffer.open(data, length);
+    file.rdbuf(&memoryBuffer);
+  }
+  else if (fileBuffer.open(filename, std::ios::in)) {
+    file.rdbuf(&fileBuffer);
+  }
+  else {
     SimpleSSD::panic("Failed to open trace file %s!", filename.c_str());
   }
 
@@ -124,13 +143,13 @@ TraceReplayer::TraceReplayer(Engine &e, BIL::BlockIOEntry &b,
 
   firstTick = std::numeric_limits<uint64_t>::max();
 
-  completionEvent = [this](uint64_t id) { iocallback(id); };
-
   submitEvent = engine.allocateEvent([this](uint64_t) { submitIO(); });
 }
 
 TraceReplayer::~TraceReplayer() {
-  file.close();
+  engine.deallocateEvent(submitEvent);
+
+  fileBuffer.close();
 }
 
 void TraceReplayer::init(uint64_t bytesize, uint32_t bs) {
@@ -142,8 +161,33 @@ void TraceReplayer::init(uint64_t bytesize, uint32_t bs) {
   }
 }
 
+void TraceReplayer::setShard(TraceShard &shard) {
+  file.seekg(shard.warmup);
+
+  consumed = shard.warmup;
+  firstByte = shard.warmup;
+  shardBegin = shard.begin;
+  shardEnd = shard.end;
+  measuring = shard.warmup >= shard.begin;
+
+  if (shardEnd > 0) {
+    fileSize = shardEnd;
+  }
+}
+
+void TraceReplayer::getShardResult(ShardResult &result) {
+  if (measuring) {
+    result.duration = engine.getCurrentTick() - measureTick;
+    result.bytes = io_submitted;
+    result.count = io_count - baseCount;
+    result.read = read_count - baseRead;
+    result.write = write_count - baseWrite;
+  }
+}
+
 void TraceReplayer::begin() {
   initTime = engine.getCurrentTick();
+  measureTick = initTime;
 
   parseLine();
 
@@ -174,33 +218,14 @@ void TraceReplayer::printStats(std::ostream &out) {
   out << "I/O (bytes): " << io_submitted << " ("
       << std::to_string((double)io_submitted / tick * 1000000000000.) << " B/s)"
       << std::endl;
-  out << "I/O (counts): " << io_count << " (Read: " << read_count
-      << ", Write: " << write_count << ")" << std::endl;
+  out << "I/O (counts): " << io_count - baseCount
+      << " (Read: " << read_count - baseRead
+      << ", Write: " << write_count - baseWrite << ")" << std::endl;
   out << "*** End of statistics ***" << std::endl;
 
   bioEntry.printStats(out);
 }
 
-void TraceReplayer::getProgress(float &val) {
-  if (max_io == 0) {
-    // If I/O count is unlimited, use file pointer for fast progress calculation
-    uint64_t ptr;
-
-    {
-      std::lock_guard<std::mutex> guard(m);
-      ptr = file.tellg();
-    }
-
-    val = (float)ptr / fileSize;
-  }
-  else {
-    // Use submitted I/O count in progress calculation
-    // If trace file contains I/O requests smaller than max_io, progress value
-    // cannot reach 1.0 (100%)
-    val = (float)io_count / max_io;
-  }
-}
-
 uint64_t TraceReplayer::mergeTime(std::smatch &match) {
   uint64_t tick = 0;
   bool valid = true;
@@ -282,16 +307,16 @@ void TraceReplayer::parseLine() {
   std::string line;
   std::smatch match;
 
+  uint64_t position;
+
   // Read line
   while (true) {
-    bool eof = false;
+    bool eof = file.eof() || (shardEnd > 0 && consumed >= shardEnd);
 
-    {
-      std::lock_guard<std::mutex> guard(m);
+    position = consumed;
 
-      eof = file.eof();
-      std::getline(file, line);
-    }
+    std::getline(file, line);
+    consumed += line.length() + 1;
 
     if (eof) {
       reserveTermination = true;
@@ -308,6 +333,15 @@ void TraceReplayer::parseLine() {
     }
   }
 
+  if (!measuring && position >= shardBegin) {
+    // First line of shard - statistics are reset when it is submitted
+    measuring = true;
+    pendingReset = true;
+    baseCount = io_count;
+    baseRead = read_count;
+    baseWrite = write_count;
+  }
+
   // Get time
   linedata.tick = mergeTime(match);
 
@@ -343,16 +377,40 @@ void TraceReplayer::submitIO() {
     SimpleSSD::panic("Unexpected request type.");
   }
 
-  bio.callback = completionEvent;
+  bio.callback = [this](uint64_t id) { iocallback(id); };
   bio.id = io_count;
   bio.type = linedata.type;
   bio.offset = linedata.offset;
   bio.length = linedata.length;
+  bio.submittedAt = engine.getCurrentTick();
+
+  if (pendingReset) {
+    // Exclude warm-up of shard
+    pendingReset = false;
+    measureTick = engine.getCurrentTick();
+    io_submitted = 0;
+
+    bioEntry.resetStats();
+    engine.resetStats();
+  }
+
+  io_submitted += bio.length;
 
   bioEntry.submitIO(bio);
 
   io_depth++;
 
+  if (max_io == 0) {
+    // If I/O count is unlimited, use parsed bytes for progress calculation
+    engine.getTelemetry().progress =
+        (double)(consumed - firstByte) / (fileSize - firstByte);
+  }
+  else {
+    // If trace file contains I/O requests smaller than max_io, progress value
+    // cannot reach 1.0 (100%)
+    engine.getTelemetry().progress = (double)io_count / max_io;
+  }
+
   if ((max_io != 0 && io_count >= max_io)) {
     reserveTermination = true;
 
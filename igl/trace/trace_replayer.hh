@@ -24,14 +24,14 @@
 
 #include <fstream>
 #include <list>
-#include <mutex>
 #include <regex>
-#include <thread>
 
 #include "bil/entry.hh"
 #include "igl/io_gen.hh"
+#include "igl/trace/trace_shard.hh"
 #include "sim/cfg_reader.hh"
 #include "sim/engine.hh"
+#include "util/mapped_file.hh"
 
 namespace IGL {
 
@@ -51,12 +51,25 @@ class TraceReplayer : public IOGenerator {
     ID_NUM
   };
 
-  std::mutex m;
-
-  std::ifstream file;
+  // Trace is read from memory when mapped by parent process
+  std::filebuf fileBuffer;
+  MemoryBuffer memoryBuffer;
+  std::istream file;
   std::regex regex;
 
   uint64_t fileSize;
+  uint64_t consumed;   // Bytes of trace file parsed
+  uint64_t firstByte;  // Offset where replay started
+
+  // Sharded replay - lines before shardBegin are not measured
+  uint64_t shardBegin;
+  uint64_t shardEnd;
+  bool measuring;
+  bool pendingReset;
+  uint64_t measureTick;
+  uint64_t baseCount;
+  uint64_t baseRead;
+  uint64_t baseWrite;
 
   TIMING_MODE mode;
   uint64_t submissionLatency;
@@ -102,7 +115,6 @@ class TraceReplayer : public IOGenerator {
   } linedata;
 
   SimpleSSD::Event submitEvent;
-  SimpleSSD::EventFunction completionEvent;
 
   void submitIO();
   void iocallback(uint64_t);
@@ -115,7 +127,10 @@ class TraceReplayer : public IOGenerator {
   void init(uint64_t, uint32_t) override;
   void begin() override;
   void printStats(std::ostream &) override;
-  void getProgress(float &) override;
+
+  // Should be called before begin
+  void setShard(TraceShard &);
+  void getShardResult(ShardResult &);
 };
 
 }  // namespace IGL
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "igl/trace/trace_shard.hh"
+
+#include <fstream>
+
+#include "simplessd/sim/trace.hh"
+#include "util/pipe.hh"
+
+// Chunk size of backward scan
+#define SCAN_SIZE 65536
+
+namespace IGL {
+
+// Returns offset of first line starting at or after offset
+static uint64_t nextLine(std::ifstream &file, uint64_t offset, uint64_t size) {
+  std::string line;
+  char c;
+
+  if (offset == 0) {
+    return 0;
+  }
+  if (offset >= size) {
+    return size;
+  }
+
+  file.clear();
+  file.seekg(offset - 1);
+  file.get(c);
+
+  if (c == '\n') {
+    return offset;
+  }
+
+  std::getline(file, line);
+
+  if (file.eof()) {
+    return size;
+  }
+
+  return (uint64_t)file.tellg();
+}
+
+// Returns offset of line which is given number of lines before offset
+static uint64_t prevLine(std::ifstream &file, uint64_t offset,
+                         uint64_t lines) {
+  std::vector<char> buffer(SCAN_SIZE);
+  uint64_t newline = 0;
+
+  // Offset is beginning of line, so character at offset - 1 is newline of
+  // previous line and is not counted
+  if (lines == 0) {
+    return offset;
+  }
+  if (offset <= 1) {
+    return 0;
+  }
+
+  uint64_t end = offset - 1;
+
+  while (end > 0) {
+    uint64_t begin = end > SCAN_SIZE ? end - SCAN_SIZE : 0;
+
+    file.clear();
+    file.seekg(begin);
+    file.read(buffer.data(), end - begin);
+
+    for (uint64_t i = end - begin; i > 0; i--) {
+      if (buffer[i - 1] == '\n' && ++newline == lines) {
+        return begin + i;
+      }
+    }
+
+    end = begin;
+  }
+
+  return 0;
+}
+
+void splitTrace(std::string filename, uint64_t count, uint64_t warmup,
+                std::vector<TraceShard> &list) {
+  std::ifstream file(filename, std::ios::binary);
+  uint64_t size;
+
+  if (!file.is_open()) {
+    SimpleSSD::panic("Failed to open trace file %s!", filename.c_str());
+  }
+
+  file.seekg(0, std::ios::end);
+  size = file.tellg();
+
+  list.clear();
+  list.resize(count);
+
+  for (uint64_t i = 0; i < count; i++) {
+    auto &shard = list.at(i);
+
+    shard.begin = i == 0 ? 0 : list.at(i - 1).end;
+    shard.end = i + 1 == count ? size : nextLine(file, size * (i + 1) / count,
+                                                 size);
+
+    if (shard.end < shard.begin) {
+      shard.end = shard.begin;
+    }
+
+    shard.warmup = prevLine(file, shard.begin, warmup);
+  }
+}
+
+void writeShardResult(int fd, ShardResult &result) {
+  std::vector<uint64_t> data;
+  uint64_t length;
+
+  writeAll(fd, &result.duration, sizeof(uint64_t));
+  writeAll(fd, &result.bytes, sizeof(uint64_t));
+  writeAll(fd, &result.count, sizeof(uint64_t));
+  writeAll(fd, &result.read, sizeof(uint64_t));
+  writeAll(fd, &result.write, sizeof(uint64_t));
+
+  result.latency.serialize(data);
+  length = data.size();
+
+  writeAll(fd, &length, sizeof(uint64_t));
+  writeAll(fd, data.data(), length * sizeof(uint64_t));
+}
+
+bool readShardResult(int fd, ShardResult &result) {
+  std::vector<uint64_t> data;
+  uint64_t length;
+
+  // Shard process exited without result
+  if (!tryReadAll(fd, &result.duration, sizeof(uint64_t))) {
+    return false;
+  }
+
+  readAll(fd, &result.bytes, sizeof(uint64_t));
+  readAll(fd, &result.count, sizeof(uint64_t));
+  readAll(fd, &result.read, sizeof(uint64_t));
+  readAll(fd, &result.write, sizeof(uint64_t));
+  readAll(fd, &length, sizeof(uint64_t));
+
+  data.resize(length);
+  readAll(fd, data.data(), length * sizeof(uint64_t));
+
+  result.latency.deserialize(data);
+  result.valid = true;
+
+  return true;
+}
+
+void printShardResult(std::ostream &out, std::vector<TraceShard> &shardList,
+                      std::vector<ShardResult> &resultList) {
+  ShardResult total;
+  uint64_t failed = 0;
+
+  out << "*** Statistics of Sharded Trace Replay ***" << std::endl;
+
+  for (uint64_t i = 0; i < resultList.size(); i++) {
+    auto &shard = shardList.at(i);
+    auto &result = resultList.at(i);
+
+    out << "Shard " << i << ": Trace (bytes): " << shard.warmup << " - "
+        << shard.begin << " - " << shard.end;
+
+    if (!result.valid) {
+      out << ", Failed" << std::endl;
+      failed++;
+
+      continue;
+    }
+
+    out << ", Time (ps): " << result.duration
+        << ", I/O (counts): " << result.count
+        << ", I/O (bytes): " << result.bytes << std::endl;
+
+    // Shards are consecutive in time
+    total.duration += result.duration;
+    total.bytes += result.bytes;
+    total.count += result.count;
+    total.read += result.read;
+    total.write += result.write;
+    total.latency.merge(result.latency);
+  }
+
+  double duration = total.duration / 1000000000000.;
+
+  if (failed > 0) {
+    out << "Failed shards (counts): " << failed
+        << " (excluded from statistics below)" << std::endl;
+  }
+
+  out << "Time (ps): " << total.duration << std::endl;
+  out << "I/O (bytes): " << total.bytes << " ("
+      << std::to_string(total.bytes / duration) << " B/s)" << std::endl;
+  out << "I/O (counts): " << total.count << " (Read: " << total.read
+      << ", Write: " << total.write << ", "
+      << std::to_string(total.count / duration) << " IOPS)" << std::endl;
+  out << "Latency (ps): min=" << total.latency.getMin()
+      << ", avg=" << std::to_string(total.latency.getMean())
+      << ", p50=" << total.latency.getPercentile(50.)
+      << ", p99=" << total.latency.getPercentile(99.)
+      << ", p99.9=" << total.latency.getPercentile(99.9)
+      << ", max=" << total.latency.getMax() << std::endl;
+  total.latency.print(out, " ps");
+  out << "*** End of statistics ***" << std::endl;
+}
+
+}  // namespace IGL
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __IGL_TRACE_SHARD__
+#define __IGL_TRACE_SHARD__
+
+#include <cinttypes>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "util/histogram.hh"
+
+namespace IGL {
+
+// Byte range of trace file replayed by one shard process
+// Lines in [warmup, begin) warm up the SSD and are not measured.
+typedef struct _TraceShard {
+  uint64_t warmup;
+  uint64_t begin;
+  uint64_t end;  // Exclusive, 0 means end of file
+
+  _TraceShard() : warmup(0), begin(0), end(0) {}
+} TraceShard;
+
+// Measured part of one shard
+typedef struct _ShardResult {
+  uint64_t duration;  // Simulated time in ps
+  uint64_t bytes;
+  uint64_t count;
+  uint64_t read;
+  uint64_t write;
+  Histogram latency;
+  bool valid;  // False when shard process exited without result
+
+  _ShardResult()
+      : duration(0),
+        bytes(0),
+        count(0),
+        read(0),
+        write(0),
+        latency(LATENCY_PRECISION),
+        valid(false) {}
+} ShardResult;
+
+// Split trace file into shards of similar size at line boundary
+// Shard i > 0 starts warm-up given number of lines before its first line.
+void splitTrace(std::string, uint64_t, uint64_t, std::vector<TraceShard> &);
+
+// Shard process sends its result to replay process through pipe
+// Read returns false when shard process exited without result
+void writeShardResult(int, ShardResult &);
+bool readShardResult(int, ShardResult &);
+
+// Merge results of all shards and print as one report
+// Failed shards are excluded
+void printShardResult(std::ostream &, std::vector<TraceShard> &,
+                      std::vector<ShardResult> &);
+
+}  // namespace IGL
+
+#endif
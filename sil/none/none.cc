@@ -56,7 +56,20 @@ void Driver::getInfo(uint64_t &bytesize, uint32_t &minbs) {
 
 void Driver::submitIO(BIL::BIO &bio) {
   SimpleSSD::HIL::Request req;
-  auto *pFunc = new std::function<void(uint64_t)>(bio.callback);
+  uint64_t slot;
+
+  // Keep callback in slot table
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = pendingIO.size();
+    pendingIO.emplace_back();
+  }
+
+  pendingIO[slot].id = bio.id;
+  pendingIO[slot].callback = std::move(bio.callback);
 
   // Convert to request
   req.reqID = bio.id;
@@ -64,10 +77,9 @@ void Driver::submitIO(BIL::BIO &bio) {
   req.range.nlp = DIVCEIL(bio.length, logicalPageSize);
   req.offset = bio.offset % logicalPageSize;
   req.length = bio.length;
-  req.context = (void *)bio.id;
-  req.function = [pFunc](uint64_t, void *context) {
-    pFunc->operator()((uint64_t)context);
-    delete pFunc;
+  req.context = (void *)slot;
+  req.function = [this](uint64_t, void *context) {
+    completion((uint64_t)context);
   };
 
   // Submit
@@ -89,6 +101,15 @@ void Driver::submitIO(BIL::BIO &bio) {
   }
 }
 
+void Driver::completion(uint64_t slot) {
+  uint64_t id = pendingIO[slot].id;
+  BIL::BIOFunction func(std::move(pendingIO[slot].callback));
+
+  freeSlot.push_back(slot);
+
+  func(id);
+}
+
 void Driver::initStats(std::vector<SimpleSSD::Stats> &list) {
   pHIL->getStatList(list, "");
   SimpleSSD::getCPUStatList(list, "cpu");
@@ -22,6 +22,8 @@
 #ifndef __DRIVERS_NONE__
 #define __DRIVERS_NONE__
 
+#include <vector>
+
 #include "bil/interface.hh"
 #include "simplessd/hil/hil.hh"
 
@@ -31,11 +33,22 @@ namespace None {
 
 class Driver : public BIL::DriverInterface {
  private:
+  typedef struct _PendingIO {
+    uint64_t id;
+    BIL::BIOFunction callback;
+  } PendingIO;
+
   SimpleSSD::HIL::HIL *pHIL;
 
   uint64_t totalLogicalPages;
   uint32_t logicalPageSize;
 
+  // Submitted I/O, indexed by slot ID (passed as request context)
+  std::vector<PendingIO> pendingIO;
+  std::vector<uint64_t> freeSlot;
+
+  void completion(uint64_t);
+
  public:
   Driver(Engine &, SimpleSSD::ConfigReader &);
   ~Driver();
@@ -27,24 +27,34 @@ namespace SIL {
 
 namespace NVMe {
 
-Driver::Driver(Engine &e, SimpleSSD::ConfigReader &conf)
+Driver::Driver(Engine &e, ConfigReader &c, SimpleSSD::ConfigReader &conf)
     : BIL::DriverInterface(e),
       dmaReadPending(false),
       dmaWritePending(false),
+      functional(false),
       phase(true),
       adminSQ(nullptr),
       adminCQ(nullptr),
       ioSQ(nullptr),
-      ioCQ(nullptr) {
+      ioCQ(nullptr),
+      ioQueueEntries(0),
+      ioInflight(0) {
   pcieGen = (SimpleSSD::PCIExpress::PCIE_GEN)conf.readInt(
       SimpleSSD::CONFIG_NVME, SimpleSSD::HIL::NVMe::NVME_PCIE_GEN);
   pcieLane = (uint8_t)conf.readUint(SimpleSSD::CONFIG_NVME,
                                     SimpleSSD::HIL::NVMe::NVME_PCIE_LANE);
 
+  // Limited further by MDTS of Identify Controller
+  maxTransferSize = c.readUint(CONFIG_GLOBAL, GLOBAL_MAX_REQUEST_SIZE);
+
   pController = new SimpleSSD::HIL::NVMe::Controller(this, conf);
 
   dmaReadEvent = engine.allocateEvent([this](uint64_t) { dmaReadDone(); });
   dmaWriteEvent = engine.allocateEvent([this](uint64_t) { dmaWriteDone(); });
+
+  ioCallback = [this](uint16_t status, uint32_t, void *context) {
+    _io(status, context);
+  };
 }
 
 Driver::~Driver() {
@@ -127,6 +137,16 @@ void Driver::init(std::function<void()> &func) {
 
 void Driver::_init0(uint16_t, void *context) {
   PRP *prp = (PRP *)context;
+  uint8_t mdts;
+
+  // Step 7-1-1. Check Maximum Data Transfer Size
+  // In unit of minimum memory page size (4KB), as power of two
+  // Zero means no limit
+  prp->readData(77, 1, &mdts);
+
+  if (mdts > 0 && maxTransferSize > (4096ull << mdts)) {
+    maxTransferSize = 4096ull << mdts;
+  }
 
   // Step 7-2. Send Identify Active Namespace List
   // Reuse PRP here
@@ -216,6 +236,14 @@ void Driver::_init2(uint16_t, void *context) {
   SimpleSSD::info("SIL::NVMe::Driver: Logical Block Size: %" PRIu32 " bytes",
                   LBAsize);
 
+  // NLB field of read/write command is 16 bits
+  maxTransferSize = MIN(maxTransferSize, 65536ull * LBAsize);
+  maxTransferSize = MAX(maxTransferSize / LBAsize, 1) * LBAsize;
+
+  SimpleSSD::info("SIL::NVMe::Driver: Maximum transfer size: %" PRIu64
+                  " bytes",
+                  maxTransferSize);
+
   // Step 8. Determine I/O queue count
   // Step 8-1. Send Set Feature
   uint32_t cmd[16];
@@ -280,6 +308,7 @@ void Driver::_init4(uint16_t status, void *) {
   }
 
   ioSQ = new Queue(entries, 64);
+  ioQueueEntries = entries;
 
   memset(cmd, 0, 64);
   cmd[0] = SimpleSSD::HIL::NVMe::OPCODE_CREATE_IO_SQUEUE;  // CID, FUSE, OPC
@@ -355,10 +384,13 @@ void Driver::getInfo(uint64_t &bytesize, uint32_t &minbs) {
 void Driver::submitIO(BIL::BIO &bio) {
   uint32_t cmd[16];
   PRP *prp = nullptr;
-  static ResponseHandler callback = [this](uint16_t status, uint32_t,
-                                           void *context) {
-    _io(status, context);
-  };
+
+  if ((bio.type == BIL::BIO_READ || bio.type == BIL::BIO_WRITE) &&
+      bio.length > maxTransferSize) {
+    splitIO(bio);
+
+    return;
+  }
 
   memset(cmd, 0, 64);
 
@@ -406,8 +438,44 @@ void Driver::submitIO(BIL::BIO &bio) {
     prp->writeData(0, 16, data);
   }
 
-  submitCommand(1, (uint8_t *)cmd, callback,
-                new IOWrapper(bio.id, prp, bio.callback));
+  issueIO(cmd, new IOWrapper(bio.id, prp, std::move(bio.callback),
+                             bio.breakdown));
+}
+
+void Driver::issueIO(uint32_t *cmd, IOWrapper *wrapper) {
+  // I/O SQ is full when tail + 1 == head. Command waits until one of
+  // in-flight commands completes, not to overwrite unfetched entry.
+  if (ioInflight + 1 >= ioQueueEntries) {
+    waitingList.emplace();
+
+    auto &io = waitingList.back();
+
+    memcpy(io.cmd, cmd, 64);
+    io.wrapper = wrapper;
+
+    return;
+  }
+
+  ioInflight++;
+
+  if (wrapper->breakdown) {
+    uint64_t begin;
+    uint64_t size;
+
+    if (wrapper->prp) {
+      wrapper->prp->getRange(begin, size);
+      prpRangeMap.emplace(begin, PRPRange{begin + size, wrapper->breakdown});
+    }
+
+    // Doorbell is rung in submitCommand at current tick
+    // Split commands share breakdown, and one may wait in waitingList
+    // after DMA of another began, so first doorbell is kept
+    if (wrapper->breakdown->tick[BIL::STAGE_DOORBELL] == BIL::NO_STAMP) {
+      wrapper->breakdown->tick[BIL::STAGE_DOORBELL] = engine.getCurrentTick();
+    }
+  }
+
+  submitCommand(1, (uint8_t *)cmd, ioCallback, wrapper);
 }
 
 void Driver::_io(uint16_t status, void *context) {
@@ -418,12 +486,80 @@ void Driver::_io(uint16_t status, void *context) {
     SimpleSSD::warn("I/O error: %04X", status);
   }
 
+  if (wrapper->breakdown) {
+    uint64_t begin;
+    uint64_t size;
+
+    if (prp) {
+      prp->getRange(begin, size);
+      prpRangeMap.erase(begin);
+    }
+
+    wrapper->breakdown->tick[BIL::STAGE_INTERRUPT] = engine.getCurrentTick();
+  }
+
+  // Issue waiting command before callback, which may submit new I/O
+  ioInflight--;
+
+  if (waitingList.size() > 0) {
+    IOCommand io = waitingList.front();
+
+    waitingList.pop();
+    issueIO(io.cmd, io.wrapper);
+  }
+
   wrapper->bioCallback(wrapper->id);
 
   delete prp;
   delete wrapper;
 }
 
+void Driver::splitIO(BIL::BIO &bio) {
+  SplitIO *parent = new SplitIO(bio.id, std::move(bio.callback),
+                                DIVCEIL(bio.length, maxTransferSize));
+
+  // All commands are submitted now, and processed in parallel by SSD
+  // They share breakdown of BIO, so doorbell is the first one and DMA and
+  // interrupt stamps cover all
+  for (uint64_t done = 0; done < bio.length; done += maxTransferSize) {
+    BIL::BIO child;
+
+    child.id = bio.id;
+    child.type = bio.type;
+    child.offset = bio.offset + done;
+    child.length = MIN(maxTransferSize, bio.length - done);
+    child.submittedAt = bio.submittedAt;
+    child.breakdown = bio.breakdown;
+    child.callback = [this, parent](uint64_t) { splitDone(parent); };
+
+    submitIO(child);
+  }
+}
+
+void Driver::splitDone(SplitIO *parent) {
+  if (--parent->pending == 0) {
+    parent->bioCallback(parent->id);
+
+    delete parent;
+  }
+}
+
+BIL::Breakdown *Driver::findBreakdown(uint64_t addr) {
+  if (prpRangeMap.size() == 0) {
+    return nullptr;
+  }
+
+  auto iter = prpRangeMap.upper_bound(addr);
+
+  if (iter == prpRangeMap.begin()) {
+    return nullptr;
+  }
+
+  iter--;
+
+  return addr < iter->second.end ? iter->second.breakdown : nullptr;
+}
+
 void Driver::initStats(std::vector<SimpleSSD::Stats> &list) {
   pController->getStatList(list, "");
   SimpleSSD::getCPUStatList(list, "cpu");
@@ -434,6 +570,10 @@ void Driver::getStats(std::vector<double> &values) {
   SimpleSSD::getCPUStatValues(values);
 }
 
+void Driver::setFunctionalMode(bool enable) {
+  functional = enable;
+}
+
 void Driver::dmaRead(uint64_t addr, uint64_t size, uint8_t *buffer,
                      SimpleSSD::DMAFunction &func, void *context) {
   if (size == 0) {
@@ -449,6 +589,7 @@ void Driver::dmaRead(uint64_t addr, uint64_t size, uint8_t *buffer,
   iter.size = size;
   iter.buffer = buffer;
   iter.context = context;
+  iter.breakdown = findBreakdown(addr);
 
   if (!dmaReadPending) {
     submitDMARead();
@@ -465,6 +606,10 @@ void Driver::dmaReadDone() {
     return;
   }
 
+  if (iter.breakdown) {
+    iter.breakdown->tick[BIL::STAGE_DMA_LAST] = tick;
+  }
+
   iter.func(tick, iter.context);
   dmaReadQueue.pop();
   dmaReadPending = false;
@@ -480,8 +625,17 @@ void Driver::submitDMARead() {
   dmaReadPending = true;
 
   iter.beginAt = engine.getCurrentTick();
-  iter.finishedAt = iter.beginAt + SimpleSSD::PCIExpress::calculateDelay(
-                                       pcieGen, pcieLane, iter.size);
+  iter.finishedAt = iter.beginAt;
+
+  if (iter.breakdown &&
+      iter.breakdown->tick[BIL::STAGE_DMA_FIRST] == BIL::NO_STAMP) {
+    iter.breakdown->tick[BIL::STAGE_DMA_FIRST] = iter.beginAt;
+  }
+
+  if (!functional) {
+    iter.finishedAt += SimpleSSD::PCIExpress::calculateDelay(pcieGen, pcieLane,
+                                                             iter.size);
+  }
 
   if (iter.buffer) {
     memcpy(iter.buffer, (uint8_t *)iter.addr, iter.size);
@@ -505,6 +659,7 @@ void Driver::dmaWrite(uint64_t addr, uint64_t size, uint8_t *buffer,
   iter.size = size;
   iter.buffer = buffer;
   iter.context = context;
+  iter.breakdown = findBreakdown(addr);
 
   if (!dmaWritePending) {
     submitDMAWrite();
@@ -521,6 +676,10 @@ void Driver::dmaWriteDone() {
     return;
   }
 
+  if (iter.breakdown) {
+    iter.breakdown->tick[BIL::STAGE_DMA_LAST] = tick;
+  }
+
   iter.func(tick, iter.context);
   dmaWriteQueue.pop();
   dmaWritePending = false;
@@ -536,8 +695,17 @@ void Driver::submitDMAWrite() {
   dmaWritePending = true;
 
   iter.beginAt = engine.getCurrentTick();
-  iter.finishedAt = iter.beginAt + SimpleSSD::PCIExpress::calculateDelay(
-                                       pcieGen, pcieLane, iter.size);
+  iter.finishedAt = iter.beginAt;
+
+  if (iter.breakdown &&
+      iter.breakdown->tick[BIL::STAGE_DMA_FIRST] == BIL::NO_STAMP) {
+    iter.breakdown->tick[BIL::STAGE_DMA_FIRST] = iter.beginAt;
+  }
+
+  if (!functional) {
+    iter.finishedAt += SimpleSSD::PCIExpress::calculateDelay(pcieGen, pcieLane,
+                                                             iter.size);
+  }
 
   if (iter.buffer) {
     memcpy((uint8_t *)iter.addr, iter.buffer, iter.size);
@@ -23,11 +23,13 @@
 #define __DRIVERS_NVME__
 
 #include <list>
+#include <map>
 #include <queue>
 
 #include "bil/interface.hh"
 #include "sil/nvme/prp.hh"
 #include "sil/nvme/queue.hh"
+#include "sim/cfg_reader.hh"
 #include "simplessd/hil/nvme/interface.hh"
 #include "simplessd/util/interface.hh"
 
@@ -47,6 +49,7 @@ typedef struct _DMAEntry {
   uint8_t *buffer;
   void *context;
   SimpleSSD::DMAFunction func;
+  BIL::Breakdown *breakdown;  // BIO which owns DMA address, if any
 
   _DMAEntry(SimpleSSD::DMAFunction &f)
       : beginAt(0),
@@ -55,7 +58,8 @@ typedef struct _DMAEntry {
         size(0),
         buffer(nullptr),
         context(nullptr),
-        func(f) {}
+        func(f),
+        breakdown(nullptr) {}
 } DMAEntry;
 
 typedef std::function<void(uint16_t, uint32_t, void *)> ResponseHandler;
@@ -75,12 +79,29 @@ typedef struct _CommandEntry {
 typedef struct _IOWrapper {
   uint64_t id;
   PRP *prp;
-  std::function<void(uint64_t)> bioCallback;
+  BIL::BIOFunction bioCallback;
+  BIL::Breakdown *breakdown;
 
-  _IOWrapper(uint64_t i, PRP *p, std::function<void(uint64_t)> &f)
-      : id(i), prp(p), bioCallback(f) {}
+  _IOWrapper(uint64_t i, PRP *p, BIL::BIOFunction &&f, BIL::Breakdown *b)
+      : id(i), prp(p), bioCallback(std::move(f)), breakdown(b) {}
 } IOWrapper;
 
+// I/O command waiting for free I/O SQ entry
+typedef struct _IOCommand {
+  uint32_t cmd[16];
+  IOWrapper *wrapper;
+} IOCommand;
+
+// BIO split into multiple commands
+typedef struct _SplitIO {
+  uint64_t id;
+  BIL::BIOFunction bioCallback;
+  uint64_t pending;  // Commands not completed
+
+  _SplitIO(uint64_t i, BIL::BIOFunction &&f, uint64_t p)
+      : id(i), bioCallback(std::move(f)), pending(p) {}
+} SplitIO;
+
 class Driver : public BIL::DriverInterface, SimpleSSD::HIL::NVMe::Interface {
  private:
   // PCI Express (for DMA throttling)
@@ -94,11 +115,13 @@ class Driver : public BIL::DriverInterface, SimpleSSD::HIL::NVMe::Interface {
   std::queue<DMAEntry> dmaWriteQueue;
   bool dmaReadPending;
   bool dmaWritePending;
+  bool functional;  // No PCIe delay when set
 
   // NVMe Identify
   uint64_t capacity;
   uint32_t LBAsize;
   uint32_t namespaceID;
+  uint64_t maxTransferSize;  // In bytes, limited by MDTS and MaxRequestSize
 
   // Queue
   uint16_t maxQueueEntries;
@@ -110,6 +133,21 @@ class Driver : public BIL::DriverInterface, SimpleSSD::HIL::NVMe::Interface {
   Queue *ioSQ;
   Queue *ioCQ;
   std::list<CommandEntry> pendingCommandList;
+  uint16_t ioQueueEntries;
+  uint32_t ioInflight;  // Submitted to I/O SQ and not completed
+  std::queue<IOCommand> waitingList;
+  ResponseHandler ioCallback;  // Completion handler of I/O command
+
+  // PRP memory of I/O with breakdown, keyed by begin address
+  // DMA to this range is accounted to the I/O
+  typedef struct _PRPRange {
+    uint64_t end;
+    BIL::Breakdown *breakdown;
+  } PRPRange;
+
+  std::map<uint64_t, PRPRange> prpRangeMap;
+
+  BIL::Breakdown *findBreakdown(uint64_t);
 
   void dmaReadDone();
   void submitDMARead();
@@ -126,11 +164,14 @@ class Driver : public BIL::DriverInterface, SimpleSSD::HIL::NVMe::Interface {
   void _init5(uint16_t, void *);
 
   void _io(uint16_t, void *);
+  void issueIO(uint32_t *, IOWrapper *);
+  void splitIO(BIL::BIO &);
+  void splitDone(SplitIO *);
 
   void submitCommand(uint16_t, uint8_t *, ResponseHandler &, void *);
 
  public:
-  Driver(Engine &, SimpleSSD::ConfigReader &);
+  Driver(Engine &, ConfigReader &, SimpleSSD::ConfigReader &);
   ~Driver();
 
   // BIL::DriverInterface
@@ -140,6 +181,7 @@ class Driver : public BIL::DriverInterface, SimpleSSD::HIL::NVMe::Interface {
 
   void initStats(std::vector<SimpleSSD::Stats> &) override;
   void getStats(std::vector<double> &) override;
+  void setFunctionalMode(bool) override;
 
   // SimpleSSD::DMAInterface
   void dmaRead(uint64_t, uint64_t, uint8_t *, SimpleSSD::DMAFunction &,
@@ -132,6 +132,11 @@ void PRP::getPointer(uint64_t &prp1, uint64_t &prp2) {
   prp2 = ptr2;
 }
 
+void PRP::getRange(uint64_t &begin, uint64_t &size) {
+  begin = (uint64_t)memory;
+  size = capacity;
+}
+
 void PRP::readData(uint64_t offset, uint64_t size, uint8_t *buffer) {
   uint64_t begin = offset / PAGE_SIZE;
   uint64_t end = DIVCEIL(offset + size, PAGE_SIZE);
@@ -46,6 +46,7 @@ class PRP {
   ~PRP();
 
   void getPointer(uint64_t &, uint64_t &);
+  void getRange(uint64_t &, uint64_t &);
   void readData(uint64_t, uint64_t, uint8_t *);
   void writeData(uint64_t, uint64_t, uint8_t *);
 };
@@ -0,0 +1,558 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sil/parallel/parallel.hh"
+
+#include <csignal>
+#include <limits>
+
+#ifndef _MSC_VER
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "sil/none/none.hh"
+#include "sil/nvme/nvme.hh"
+#include "simplessd/util/algorithm.hh"
+#include "simplessd/util/simplessd.hh"
+#include "util/pipe.hh"
+
+namespace SIL {
+
+namespace Parallel {
+
+enum : uint32_t {
+  // Host to worker
+  MSG_SUBMIT,
+  MSG_ADVANCE,
+  MSG_STATS,
+  MSG_EXIT,
+
+  // Worker to host
+  MSG_READY,
+  MSG_COMPLETION,
+  MSG_DONE,
+  MSG_STAT_VALUES,
+};
+
+#define NO_TICK std::numeric_limits<uint64_t>::max()
+
+#ifndef _MSC_VER
+
+// Worker side of multi-device mode - one simulated SSD
+class Device {
+ private:
+  Engine engine;
+  BIL::DriverInterface *pDriver;
+
+  int in;
+  int out;
+
+  bool ready;
+  std::deque<Message> submitQueue;  // Sorted by tick
+  std::vector<Message> sendBuffer;
+  SimpleSSD::Event submitEvent;
+
+  void submit(uint64_t tick) {
+    while (submitQueue.size() > 0 && submitQueue.front().tick <= tick) {
+      auto &msg = submitQueue.front();
+      BIL::BIO bio;
+
+      bio.id = msg.id;
+      bio.type = (BIL::BIO_TYPE)msg.type;
+      bio.offset = msg.offset;
+      bio.length = msg.length;
+      bio.callback = [this](uint64_t id) { completion(id); };
+
+      submitQueue.pop_front();
+
+      pDriver->submitIO(bio);
+    }
+
+    if (submitQueue.size() > 0) {
+      engine.scheduleEvent(submitEvent, submitQueue.front().tick);
+    }
+  }
+
+  void completion(uint64_t id) {
+    Message msg;
+
+    msg.command = MSG_COMPLETION;
+    msg.tick = engine.getCurrentTick();
+    msg.id = id;
+
+    sendBuffer.push_back(msg);
+  }
+
+  void flush() {
+    writeAll(out, sendBuffer.data(), sendBuffer.size() * sizeof(Message));
+    sendBuffer.clear();
+  }
+
+ public:
+  Device(ConfigReader &conf, std::string &ssdConfig, std::ostream *pLog,
+         int i, int o)
+      : engine((EVENT_QUEUE)conf.readUint(CONFIG_GLOBAL, GLOBAL_EVENT_QUEUE)),
+        pDriver(nullptr),
+        in(i),
+        out(o),
+        ready(false) {
+    auto ssdConf = initSimpleSSDEngine(&engine, pLog, pLog, ssdConfig);
+
+    switch (conf.readUint(CONFIG_GLOBAL, GLOBAL_INTERFACE)) {
+      case INTERFACE_NONE:
+        pDriver = new SIL::None::Driver(engine, ssdConf);
+
+        break;
+      case INTERFACE_NVME:
+        pDriver = new SIL::NVMe::Driver(engine, conf, ssdConf);
+
+        break;
+      default:
+        SimpleSSD::panic("Undefined interface specified.");
+
+        break;
+    }
+
+    submitEvent =
+        engine.allocateEvent([this](uint64_t tick) { submit(tick); });
+  }
+
+  ~Device() {
+    delete pDriver;
+
+    releaseSimpleSSDEngine();
+  }
+
+  void run() {
+    Message msg;
+    std::vector<SimpleSSD::Stats> list;
+    std::function<void()> beginCallback = [this]() { ready = true; };
+
+    // Run until device initialization finished
+    pDriver->init(beginCallback);
+
+    while (!ready && engine.doNextBatch())
+      ;
+
+    if (!ready) {
+      SimpleSSD::panic("Failed to initialize device");
+    }
+
+    uint64_t bytesize;
+    uint32_t lbasize;
+
+    pDriver->getInfo(bytesize, lbasize);
+    pDriver->initStats(list);
+
+    msg.command = MSG_READY;
+    msg.tick = engine.getCurrentTick();
+    msg.id = list.size();
+    msg.offset = bytesize;
+    msg.length = lbasize;
+
+    writeAll(out, &msg, sizeof(msg));
+
+    for (auto &stat : list) {
+      writeString(out, stat.name);
+      writeString(out, stat.desc);
+    }
+
+    while (true) {
+      readAll(in, &msg, sizeof(msg));
+
+      switch (msg.command) {
+        case MSG_SUBMIT:
+          // Host sends submissions in tick order
+          submitQueue.push_back(msg);
+
+          if (!engine.isScheduled(submitEvent)) {
+            engine.scheduleEvent(submitEvent, msg.tick);
+          }
+
+          break;
+        case MSG_ADVANCE: {
+          uint64_t tick;
+
+          // Run events in current window
+          while (engine.getNextTick(tick) && tick < msg.tick) {
+            engine.doNextBatch();
+          }
+
+          msg.command = MSG_DONE;
+          msg.tick = engine.getNextTick(tick) ? tick : NO_TICK;
+
+          sendBuffer.push_back(msg);
+          flush();
+        } break;
+        case MSG_STATS: {
+          std::vector<double> values;
+
+          pDriver->getStats(values);
+
+          msg.command = MSG_STAT_VALUES;
+          msg.id = values.size();
+
+          writeAll(out, &msg, sizeof(msg));
+          writeAll(out, values.data(), values.size() * sizeof(double));
+        } break;
+        case MSG_EXIT:
+          return;
+        default:
+          SimpleSSD::panic("Unexpected message from host");
+
+          break;
+      }
+    }
+  }
+};
+
+#endif
+
+Driver::Driver(Engine &e, ConfigReader &conf, std::string ssdConfig,
+               std::ostream *pLog)
+    : BIL::DriverInterface(e),
+      deviceSize(std::numeric_limits<uint64_t>::max()),
+      lbaSize(0) {
+  uint64_t count = conf.readUint(CONFIG_GLOBAL, GLOBAL_DEVICE_COUNT);
+
+  stripeSize = conf.readUint(CONFIG_GLOBAL, GLOBAL_STRIPE_SIZE);
+  lookahead = conf.readUint(CONFIG_GLOBAL, GLOBAL_COMPLETION_LATENCY);
+
+#ifdef _MSC_VER
+  (void)count;
+  (void)ssdConfig;
+  (void)pLog;
+
+  SimpleSSD::panic("Multi-device mode is not supported on Windows");
+#else
+  workerList.resize(count);
+
+  for (uint64_t i = 0; i < count; i++) {
+    int toWorker[2];
+    int toHost[2];
+
+    if (pipe(toWorker) != 0 || pipe(toHost) != 0) {
+      SimpleSSD::panic("Failed to create pipe");
+    }
+
+    // Do not duplicate buffered output
+    std::cout.flush();
+    std::cerr.flush();
+
+    if (pLog) {
+      pLog->flush();
+    }
+
+    int pid = fork();
+
+    if (pid < 0) {
+      SimpleSSD::panic("Failed to create worker process");
+    }
+    else if (pid == 0) {
+      // Host handles Ctrl+C and terminates workers by closing pipes
+      signal(SIGINT, SIG_IGN);
+
+      for (uint64_t j = 0; j < i; j++) {
+        close(workerList[j].in);
+        close(workerList[j].out);
+      }
+
+      close(toWorker[1]);
+      close(toHost[0]);
+
+      {
+        Device device(conf, ssdConfig, pLog, toWorker[0], toHost[1]);
+
+        device.run();
+      }
+
+      // Skip destructors of objects inherited from host
+      _exit(0);
+    }
+
+    close(toWorker[0]);
+    close(toHost[1]);
+
+    workerList[i].pid = pid;
+    workerList[i].in = toHost[0];
+    workerList[i].out = toWorker[1];
+  }
+
+  // Wait for initialization of devices
+  for (uint64_t i = 0; i < count; i++) {
+    auto &worker = workerList[i];
+    std::string prefix = "ssd" + std::to_string(i) + ".";
+    Message msg;
+
+    readAll(worker.in, &msg, sizeof(msg));
+
+    if (msg.command != MSG_READY) {
+      SimpleSSD::panic("Unexpected message from worker");
+    }
+
+    worker.readyAt = msg.tick;
+    worker.bytesize = msg.offset;
+    worker.lbasize = (uint32_t)msg.length;
+
+    for (uint64_t j = 0; j < msg.id; j++) {
+      SimpleSSD::Stats stat;
+
+      stat.name = prefix + readString(worker.in);
+      stat.desc = readString(worker.in);
+
+      statList.push_back(stat);
+    }
+
+    deviceSize = MIN(deviceSize, worker.bytesize / stripeSize * stripeSize);
+    lbaSize = MAX(lbaSize, worker.lbasize);
+  }
+
+  if (deviceSize == 0) {
+    SimpleSSD::panic("Stripe size is larger than device capacity");
+  }
+#endif
+
+  beginEvent = engine.allocateEvent([this](uint64_t) { beginFunction(); });
+  syncEvent = engine.allocateEvent([this](uint64_t tick) { sync(tick); });
+  completionEvent =
+      engine.allocateEvent([this](uint64_t tick) { completion(tick); });
+}
+
+Driver::~Driver() {
+#ifndef _MSC_VER
+  Message msg;
+
+  msg.command = MSG_EXIT;
+
+  for (auto &worker : workerList) {
+    send(worker, msg);
+
+    close(worker.in);
+    close(worker.out);
+  }
+
+  for (auto &worker : workerList) {
+    waitpid(worker.pid, nullptr, 0);
+  }
+#endif
+}
+
+void Driver::send(Worker &worker, Message &msg) {
+#ifndef _MSC_VER
+  worker.sendBuffer.push_back(msg);
+
+  // Submissions are sent together with next advance message
+  if (msg.command != MSG_SUBMIT) {
+    writeAll(worker.out, worker.sendBuffer.data(),
+             worker.sendBuffer.size() * sizeof(Message));
+    worker.sendBuffer.clear();
+  }
+#else
+  (void)worker;
+  (void)msg;
+#endif
+}
+
+void Driver::init(std::function<void()> &func) {
+  uint64_t begin = 0;
+
+  beginFunction = func;
+
+  for (auto &worker : workerList) {
+    begin = MAX(begin, worker.readyAt);
+  }
+
+  engine.scheduleEvent(beginEvent, begin);
+  engine.scheduleEvent(syncEvent, begin + lookahead);
+
+  SimpleSSD::info("SIL::Parallel::Driver: %" PRIu64 " devices, Total SSD "
+                  "capacity: %" PRIu64 " bytes",
+                  (uint64_t)workerList.size(), deviceSize * workerList.size());
+  SimpleSSD::info("SIL::Parallel::Driver: Stripe size: %" PRIu64
+                  " bytes, Lookahead: %" PRIu64 " ps",
+                  stripeSize, lookahead);
+}
+
+void Driver::getInfo(uint64_t &bytesize, uint32_t &minbs) {
+  bytesize = deviceSize * workerList.size();
+  minbs = lbaSize;
+}
+
+void Driver::submitIO(BIL::BIO &bio) {
+  uint64_t count = workerList.size();
+  uint64_t slot;
+  Message msg;
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = pendingIO.size();
+    pendingIO.emplace_back();
+  }
+
+  auto &io = pendingIO[slot];
+
+  io.id = bio.id;
+  io.remaining = 0;
+  io.callback = std::move(bio.callback);
+
+  msg.command = MSG_SUBMIT;
+  msg.type = bio.type;
+  msg.tick = engine.getCurrentTick();
+  msg.id = slot;
+
+  if (bio.type == BIL::BIO_FLUSH) {
+    // Flush all devices
+    for (auto &worker : workerList) {
+      send(worker, msg);
+    }
+
+    io.remaining = count;
+  }
+  else {
+    // Split by stripe
+    uint64_t offset = bio.offset;
+    uint64_t end = bio.offset + bio.length;
+
+    do {
+      uint64_t stripe = offset / stripeSize;
+      uint64_t length = MIN(end, (stripe + 1) * stripeSize) - offset;
+
+      msg.offset = stripe / count * stripeSize + offset % stripeSize;
+      msg.length = length;
+
+      send(workerList[stripe % count], msg);
+
+      io.remaining++;
+      offset += length;
+    } while (offset < end);
+  }
+}
+
+void Driver::sync(uint64_t tick) {
+#ifndef _MSC_VER
+  uint64_t next = NO_TICK;
+  uint64_t hostTick;
+  Message msg;
+
+  // Workers simulate window [previous sync, tick) in parallel
+  msg.command = MSG_ADVANCE;
+  msg.tick = tick;
+
+  for (auto &worker : workerList) {
+    send(worker, msg);
+  }
+
+  for (auto &worker : workerList) {
+    while (true) {
+      readAll(worker.in, &msg, sizeof(msg));
+
+      if (msg.command == MSG_COMPLETION) {
+        // Completion at device is delivered after lookahead, so delivery
+        // time is never earlier than current tick
+        completionQueue.emplace(msg.tick + lookahead, msg.id);
+      }
+      else if (msg.command == MSG_DONE) {
+        next = MIN(next, msg.tick);
+
+        break;
+      }
+      else {
+        SimpleSSD::panic("Unexpected message from worker");
+      }
+    }
+  }
+
+  if (completionQueue.size() > 0 && !engine.isScheduled(completionEvent)) {
+    engine.scheduleEvent(completionEvent, completionQueue.top().tick);
+  }
+
+  // Next window ends lookahead after earliest pending event, because any
+  // completion in the window cannot happen before that event
+  if (engine.getNextTick(hostTick)) {
+    next = MIN(next, hostTick);
+  }
+
+  if (next != NO_TICK) {
+    engine.scheduleEvent(syncEvent, next + lookahead);
+  }
+#else
+  (void)tick;
+#endif
+}
+
+void Driver::completion(uint64_t tick) {
+  while (completionQueue.size() > 0 && completionQueue.top().tick <= tick) {
+    uint64_t slot = completionQueue.top().slot;
+    auto &io = pendingIO[slot];
+
+    completionQueue.pop();
+
+    if (--io.remaining == 0) {
+      uint64_t id = io.id;
+      BIL::BIOFunction func(std::move(io.callback));
+
+      freeSlot.push_back(slot);
+
+      func(id);
+    }
+  }
+
+  if (completionQueue.size() > 0) {
+    engine.scheduleEvent(completionEvent, completionQueue.top().tick);
+  }
+}
+
+void Driver::initStats(std::vector<SimpleSSD::Stats> &list) {
+  list.insert(list.end(), statList.begin(), statList.end());
+}
+
+void Driver::getStats(std::vector<double> &values) {
+#ifndef _MSC_VER
+  Message msg;
+
+  msg.command = MSG_STATS;
+
+  for (auto &worker : workerList) {
+    send(worker, msg);
+  }
+
+  for (auto &worker : workerList) {
+    uint64_t offset = values.size();
+
+    readAll(worker.in, &msg, sizeof(msg));
+
+    if (msg.command != MSG_STAT_VALUES) {
+      SimpleSSD::panic("Unexpected message from worker");
+    }
+
+    values.resize(offset + msg.id);
+    readAll(worker.in, values.data() + offset, msg.id * sizeof(double));
+  }
+#else
+  (void)values;
+#endif
+}
+
+}  // namespace Parallel
+
+}  // namespace SIL
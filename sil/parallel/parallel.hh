@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __DRIVERS_PARALLEL__
+#define __DRIVERS_PARALLEL__
+
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "bil/interface.hh"
+
+namespace SIL {
+
+namespace Parallel {
+
+// Multi-device driver
+//
+// Each SSD is simulated by worker process with its own Engine, driver and
+// SimpleSSD instance (SimpleSSD keeps simulator and CPU model in global
+// variables, so instances cannot share one process). Address space is
+// striped over devices.
+//
+// Host and workers are synchronized by conservative time window. Completion
+// of device is delivered to host after CompletionLatency, so host can run
+// [T, T + lookahead) without knowing device events after T. Workers run
+// each window in parallel.
+
+typedef struct _Message {
+  uint32_t command;
+  uint32_t type;  // BIL::BIO_TYPE of MSG_SUBMIT
+  uint64_t tick;
+  uint64_t id;
+  uint64_t offset;
+  uint64_t length;
+
+  _Message() : command(0), type(0), tick(0), id(0), offset(0), length(0) {}
+} Message;
+
+typedef struct _Worker {
+  int pid;
+  int in;   // Worker to host
+  int out;  // Host to worker
+
+  uint64_t bytesize;
+  uint32_t lbasize;
+  uint64_t readyAt;  // Initialization finished
+
+  std::vector<Message> sendBuffer;
+} Worker;
+
+class Driver : public BIL::DriverInterface {
+ private:
+  typedef struct _PendingIO {
+    uint64_t id;
+    uint64_t remaining;  // Chunks not completed yet
+    BIL::BIOFunction callback;
+  } PendingIO;
+
+  typedef struct _Completion {
+    uint64_t tick;  // Delivery time at host
+    uint64_t slot;
+
+    _Completion(uint64_t t, uint64_t s) : tick(t), slot(s) {}
+
+    bool operator>(const _Completion &rhs) const { return tick > rhs.tick; }
+  } Completion;
+
+  std::vector<Worker> workerList;
+
+  uint64_t stripeSize;
+  uint64_t lookahead;
+  uint64_t deviceSize;  // Usable bytes per device (multiple of stripe)
+  uint32_t lbaSize;
+
+  std::vector<PendingIO> pendingIO;
+  std::vector<uint64_t> freeSlot;
+  std::priority_queue<Completion, std::vector<Completion>,
+                      std::greater<Completion>>
+      completionQueue;
+
+  std::vector<SimpleSSD::Stats> statList;
+
+  SimpleSSD::Event beginEvent;
+  SimpleSSD::Event syncEvent;
+  SimpleSSD::Event completionEvent;
+
+  void send(Worker &, Message &);
+  void sync(uint64_t);
+  void completion(uint64_t);
+
+ public:
+  Driver(Engine &, ConfigReader &, std::string, std::ostream *);
+  ~Driver();
+
+  void init(std::function<void()> &) override;
+  void getInfo(uint64_t &, uint32_t &) override;
+  void submitIO(BIL::BIO &) override;
+
+  void initStats(std::vector<SimpleSSD::Stats> &) override;
+  void getStats(std::vector<double> &) override;
+};
+
+}  // namespace Parallel
+
+}  // namespace SIL
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/differential.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "simplessd/sim/trace.hh"
+
+Differential::Differential(Simulation &a, Simulation &b, std::ostream *o)
+    : primary(a),
+      secondary(b),
+      pLatencyFile(o),
+      functional(false),
+      readyCount(0),
+      pBeginCallback(nullptr),
+      sameCount(0),
+      minDelta(std::numeric_limits<int64_t>::max()),
+      maxDelta(std::numeric_limits<int64_t>::min()),
+      sumDelta(0.),
+      squareSumDelta(0.),
+      slowerDelta(LATENCY_PRECISION),
+      fasterDelta(LATENCY_PRECISION) {
+  auto &engine = primary.getEngine();
+
+  beginEvent = engine.allocateEvent([this](uint64_t) {
+    uint64_t bytesizeA;
+    uint64_t bytesizeB;
+    uint32_t bs;
+
+    // I/O generator only knows size of primary device
+    primary.getInterface().getInfo(bytesizeA, bs);
+    secondary.getInterface().getInfo(bytesizeB, bs);
+
+    if (bytesizeB < bytesizeA) {
+      SimpleSSD::panic("Device B is smaller than device A");
+    }
+
+    (*pBeginCallback)();
+  });
+  doneEvent = engine.allocateEvent([this](uint64_t) { deliver(); });
+
+  readyCallback = [this]() {
+    if (++readyCount == 2) {
+      schedule(beginEvent);
+    }
+  };
+
+  primary.getBlockIO().setMirror(this);
+}
+
+Differential::~Differential() {
+  primary.getBlockIO().setMirror(nullptr);
+  primary.getEngine().deallocateEvent(beginEvent);
+  primary.getEngine().deallocateEvent(doneEvent);
+}
+
+void Differential::init(std::function<void()> &callback) {
+  pBeginCallback = &callback;
+
+  secondary.activate();
+  secondary.getInterface().init(readyCallback);
+
+  primary.activate();
+  primary.getInterface().init(readyCallback);
+}
+
+bool Differential::doNextBatch() {
+  auto &engineA = primary.getEngine();
+  auto &engineB = secondary.getEngine();
+  uint64_t tickA;
+  uint64_t tickB;
+
+  if (engineA.isStopped()) {
+    return false;
+  }
+
+  bool hasA = engineA.getNextTick(tickA);
+  bool hasB = engineB.getNextTick(tickB);
+
+  // Primary context is active by default
+  if (hasB && (!hasA || tickB <= tickA)) {
+    secondary.activate();
+    engineB.doNextBatch();
+    primary.activate();
+
+    return true;
+  }
+
+  return engineA.doNextBatch();
+}
+
+void Differential::schedule(SimpleSSD::Event eid) {
+  // Context with earlier tick runs first, so current tick of running context
+  // is never behind the other one
+  uint64_t tick = std::max(primary.getEngine().getCurrentTick(),
+                           secondary.getEngine().getCurrentTick());
+
+  primary.getEngine().scheduleEvent(eid, tick);
+}
+
+void Differential::submitIO(BIL::BIO &bio) {
+  BIL::BIO copy;
+  uint64_t slot;
+
+  if (freeSlot.size() > 0) {
+    slot = freeSlot.back();
+    freeSlot.pop_back();
+  }
+  else {
+    slot = pendingIO.size();
+    pendingIO.emplace_back();
+  }
+
+  auto &io = pendingIO[slot];
+
+  io.id = bio.id;
+  io.offset = bio.offset;
+  io.length = bio.length;
+  io.submittedAt = primary.getEngine().getCurrentTick();
+  io.remaining = 2;
+  io.callback = std::move(bio.callback);
+
+  bio.callback = [this, slot](uint64_t) { completion(slot, 0); };
+
+  copy.id = bio.id;
+  copy.type = bio.type;
+  copy.offset = bio.offset;
+  copy.length = bio.length;
+  copy.submittedAt = bio.submittedAt;
+  copy.callback = [this, slot](uint64_t) { completion(slot, 1); };
+
+  // Secondary device receives I/O at same tick
+  secondary.advance(io.submittedAt);
+  secondary.getBlockIO().submitIO(copy);
+  primary.activate();
+}
+
+void Differential::completion(uint64_t slot, uint32_t side) {
+  auto &io = pendingIO[slot];
+  auto &engine = side == 0 ? primary.getEngine() : secondary.getEngine();
+
+  io.latency[side] = engine.getCurrentTick() - io.submittedAt;
+
+  // I/O generator runs in primary context
+  if (--io.remaining == 0) {
+    doneList.push_back(slot);
+    schedule(doneEvent);
+  }
+}
+
+void Differential::deliver() {
+  std::vector<uint64_t> list;
+
+  // Callback may submit new I/O
+  list.swap(doneList);
+
+  for (auto slot : list) {
+    auto &io = pendingIO[slot];
+    uint64_t id = io.id;
+    BIL::BIOFunction callback = std::move(io.callback);
+
+    if (!functional) {
+      compare(io);
+    }
+
+    freeSlot.push_back(slot);
+
+    callback(id);
+  }
+}
+
+void Differential::compare(PendingIO &io) {
+  int64_t delta = (int64_t)(io.latency[1] - io.latency[0]);
+
+  if (delta > 0) {
+    slowerDelta.add((uint64_t)delta);
+  }
+  else if (delta < 0) {
+    fasterDelta.add((uint64_t)-delta);
+  }
+  else {
+    sameCount++;
+  }
+
+  minDelta = std::min(minDelta, delta);
+  maxDelta = std::max(maxDelta, delta);
+  sumDelta += (double)delta;
+  squareSumDelta += (double)delta * delta;
+
+  if (pLatencyFile) {
+    *pLatencyFile << std::to_string(io.id) << ", "
+                  << std::to_string(io.offset) << ", "
+                  << std::to_string(io.length) << ", "
+                  << std::to_string(io.latency[0]) << ", "
+                  << std::to_string(io.latency[1]) << ", "
+                  << std::to_string(delta) << "\n";
+  }
+}
+
+void Differential::resetStats() {
+  secondary.getBlockIO().resetStats();
+  secondary.getEngine().resetStats();
+
+  sameCount = 0;
+  minDelta = std::numeric_limits<int64_t>::max();
+  maxDelta = std::numeric_limits<int64_t>::min();
+  sumDelta = 0.;
+  squareSumDelta = 0.;
+  slowerDelta.reset();
+  fasterDelta.reset();
+}
+
+void Differential::setFunctionalMode(bool enable) {
+  functional = enable;
+
+  secondary.getBlockIO().setFunctionalMode(enable);
+}
+
+void Differential::printLatency(std::ostream &out, const char *name,
+                                Histogram &hist) {
+  out << name << ": count=" << hist.getCount() << ", min=" << hist.getMin()
+      << ", avg=" << std::to_string(hist.getMean())
+      << ", p50=" << hist.getPercentile(50.)
+      << ", p99=" << hist.getPercentile(99.)
+      << ", p99.9=" << hist.getPercentile(99.9) << ", max=" << hist.getMax()
+      << std::endl;
+}
+
+void Differential::printStats(std::ostream &out) {
+  uint64_t count =
+      slowerDelta.getCount() + fasterDelta.getCount() + sameCount;
+  double avg = 0.;
+  double stdev = 0.;
+
+  if (count > 0) {
+    avg = sumDelta / count;
+    stdev = sqrt(std::max(squareSumDelta / count - avg * avg, 0.));
+  }
+
+  secondary.getBlockIO().printStats(out);
+
+  out << "*** Statistics of Differential Comparison ***" << std::endl;
+  out << "Compared I/O (counts): " << count << std::endl;
+  printLatency(out, "Latency of A (ps)", primary.getBlockIO().getLatency());
+  printLatency(out, "Latency of B (ps)", secondary.getBlockIO().getLatency());
+
+  if (count > 0) {
+    out << "Latency delta B - A (ps): min=" << minDelta << ", max=" << maxDelta
+        << ", avg=" << std::to_string(avg)
+        << ", stdev=" << std::to_string(stdev) << std::endl;
+  }
+
+  out << "B slower: " << slowerDelta.getCount()
+      << ", B faster: " << fasterDelta.getCount() << ", same: " << sameCount
+      << std::endl;
+  printLatency(out, "Delta when B slower (ps)", slowerDelta);
+  printLatency(out, "Delta when B faster (ps)", fasterDelta);
+  out << "*** End of statistics ***" << std::endl;
+}
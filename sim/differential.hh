@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_DIFFERENTIAL__
+#define __SIM_DIFFERENTIAL__
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "bil/entry.hh"
+#include "sim/simulation.hh"
+#include "util/histogram.hh"
+
+// Differential mode - runs two simulation contexts in lockstep
+// I/O stream of primary context (which runs I/O generator) is copied to
+// secondary context at the same tick. I/O completes to I/O generator after
+// both devices complete it, so both devices see identical arrival times.
+class Differential : public BIL::Mirror {
+ private:
+  typedef struct _PendingIO {
+    uint64_t id;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t submittedAt;
+    uint64_t latency[2];
+    uint32_t remaining;
+    BIL::BIOFunction callback;
+  } PendingIO;
+
+  Simulation &primary;
+  Simulation &secondary;
+  std::ostream *pLatencyFile;
+  bool functional;  // Do not compare when set
+
+  // Submitted I/O, indexed by slot ID
+  std::vector<PendingIO> pendingIO;
+  std::vector<uint64_t> freeSlot;
+  std::vector<uint64_t> doneList;  // Completed by both devices
+
+  // Events of primary context
+  SimpleSSD::Event beginEvent;
+  SimpleSSD::Event doneEvent;
+
+  uint32_t readyCount;
+  std::function<void()> readyCallback;
+  std::function<void()> *pBeginCallback;
+
+  // Statistics (delta = latency of B - latency of A)
+  uint64_t sameCount;
+  int64_t minDelta;
+  int64_t maxDelta;
+  double sumDelta;
+  double squareSumDelta;
+  Histogram slowerDelta;  // Positive delta
+  Histogram fasterDelta;  // Negative delta, stored as absolute value
+
+  void schedule(SimpleSSD::Event);
+  void completion(uint64_t, uint32_t);
+  void deliver();
+  void compare(PendingIO &);
+  void printLatency(std::ostream &, const char *, Histogram &);
+
+ public:
+  Differential(Simulation &, Simulation &, std::ostream *);
+  ~Differential();
+
+  // Initialize drivers of both contexts, callback is called in primary
+  // context when both are ready
+  void init(std::function<void()> &);
+
+  // Handle events of context with earlier tick first
+  bool doNextBatch();
+
+  void submitIO(BIL::BIO &) override;
+  void resetStats() override;
+  void setFunctionalMode(bool) override;
+
+  void printStats(std::ostream &);
+};
+
+#endif
@@ -19,206 +19,230 @@
 
 #include "sim/engine.hh"
 
+#include <chrono>
+
+#include "sim/heap_queue.hh"
+#include "sim/wheel_queue.hh"
 #include "simplessd/sim/trace.hh"
 
-Engine::Engine()
+Engine::Engine(EVENT_QUEUE type, bool profile)
     : SimpleSSD::Simulator(),
       simTick(0),
-      counter(0),
       forceStop(false),
-      eventHandled(0) {
-  watch.start();
-}
-
-Engine::~Engine() {}
+      eventQueue(nullptr),
+      eventHandled(0),
+      profiler(nullptr),
+      scheduleCount(0),
+      rescheduleCount(0),
+      sameTickCount(0),
+      descheduleCount(0),
+      pastScheduleCount(0),
+      collisionCount(0),
+      queueLength(0),
+      distance(0) {
+  switch (type) {
+    case EVENT_QUEUE_HEAP:
+      eventQueue = new HeapQueue();
 
-bool Engine::insertEvent(SimpleSSD::Event eid, uint64_t tick,
-                         uint64_t *pOldTick) {
-  bool found = false;
-  bool flag = false;
-  auto old = eventQueue.begin();
-  auto insert = eventQueue.end();
-
-  for (auto iter = eventQueue.begin(); iter != eventQueue.end(); iter++) {
-    if (iter->first == eid) {
-      found = true;
-      old = iter;
+      break;
+    case EVENT_QUEUE_WHEEL:
+      eventQueue = new WheelQueue();
 
-      if (pOldTick) {
-        *pOldTick = iter->second;
-      }
-    }
+      break;
+    default:
+      SimpleSSD::panic("Invalid event queue specified");
 
-    if (iter->second > tick && !flag) {
-      insert = iter;
-      flag = true;
-    }
+      break;
   }
 
-  if (found && pOldTick) {
-    if (*pOldTick == tick) {
-      // Rescheduling to same tick. Ignore.
-      return false;
-    }
+  if (profile) {
+    profiler = new Profiler();
   }
 
-  // Iterator will not invalidated on insert
-  // Do insert first
-  eventQueue.insert(insert, {eid, tick});
-
-  if (found) {
-    eventQueue.erase(old);
-  }
+  // Event ID 0 is never allocated
+  eventList.emplace_back();
 
-  return found;
+  watch.start();
 }
 
-bool Engine::removeEvent(SimpleSSD::Event eid) {
-  bool found = false;
+Engine::~Engine() {
+  delete eventQueue;
+  delete profiler;
+}
 
-  for (auto iter = eventQueue.begin(); iter != eventQueue.end(); iter++) {
-    if (iter->first == eid) {
-      eventQueue.erase(iter);
-      found = true;
+uint64_t Engine::getCurrentTick() {
+  return simTick;
+}
 
-      break;
-    }
+Engine::EventData &Engine::getEventData(SimpleSSD::Event eid) {
+  if (eid >= eventList.size() || !eventList[eid].allocated) {
+    SimpleSSD::panic("Event %" PRIu64 " does not exists", eid);
   }
 
-  return found;
+  return eventList[eid];
 }
 
-bool Engine::isEventExist(SimpleSSD::Event eid, uint64_t *pTick) {
-  for (auto &iter : eventQueue) {
-    if (iter.first == eid) {
-      if (pTick) {
-        *pTick = iter.second;
-      }
+SimpleSSD::Event Engine::allocate(Callback &&func, uint32_t profile) {
+  SimpleSSD::Event eid;
 
-      return true;
-    }
+  // Reuse deallocated event ID first
+  if (freeList.size() > 0) {
+    eid = freeList.back();
+    freeList.pop_back();
+  }
+  else {
+    eid = eventList.size();
+    eventList.emplace_back();
   }
 
-  return false;
-}
+  auto &data = eventList[eid];
 
-uint64_t Engine::getCurrentTick() {
-  std::lock_guard<std::mutex> guard(mTick);
+  data.func = std::move(func);
+  data.profile = profile;
+  data.allocated = true;
+  data.scheduled = false;
 
-  return simTick;
+  return eid;
 }
 
 SimpleSSD::Event Engine::allocateEvent(SimpleSSD::EventFunction func) {
-  auto iter = eventList.insert({++counter, func});
+  uint32_t profile = profileID(func.target_type());
 
-  if (!iter.second) {
-    SimpleSSD::panic("Fail to allocate event");
-  }
-
-  return counter;
+  return allocate(Callback(std::move(func)), profile);
 }
 
 void Engine::scheduleEvent(SimpleSSD::Event eid, uint64_t tick) {
-  auto iter = eventList.find(eid);
-
-  if (iter != eventList.end()) {
-    uint64_t tickCopy;
-
-    {
-      std::lock_guard<std::mutex> guard(mTick);
-      tickCopy = simTick;
+  auto &data = getEventData(eid);
+
+  if (tick < simTick) {
+    // Print first one only, and count others
+    if (pastScheduleCount++ == 0) {
+      SimpleSSD::warn("Tried to schedule %" PRIu64 " < simTick to event %" PRIu64
+                      ". Set tick as simTick. Further warnings are counted "
+                      "in statistics.",
+                      tick, eid);
     }
 
-    if (tick < tickCopy) {
-      SimpleSSD::warn("Tried to schedule %" PRIu64
-                      " < simTick to event %" PRIu64 ". Set tick as simTick.",
-                      tick, eid);
+    tick = simTick;
+  }
 
-      tick = tickCopy;
-    }
+  if (data.scheduled) {
+    if (data.tick == tick) {
+      // Rescheduling to same tick. Ignore.
+      sameTickCount++;
 
-    uint64_t oldTick;
+      return;
+    }
 
-    if (insertEvent(eid, tick, &oldTick)) {
+    if (rescheduleCount++ == 0) {
       SimpleSSD::warn("Event %" PRIu64 " rescheduled from %" PRIu64
-                      " to %" PRIu64,
-                      eid, oldTick, tick);
+                      " to %" PRIu64
+                      ". Further warnings are counted in statistics.",
+                      eid, data.tick, tick);
     }
   }
   else {
-    SimpleSSD::panic("Event %" PRIu64 " does not exists", eid);
+    scheduleCount++;
   }
+
+  distance.add(tick - simTick);
+  eventQueue->insert(eid, tick);
+
+  data.tick = tick;
+  data.scheduled = true;
 }
 
 void Engine::descheduleEvent(SimpleSSD::Event eid) {
-  auto iter = eventList.find(eid);
+  auto &data = getEventData(eid);
 
-  if (iter != eventList.end()) {
-    removeEvent(eid);
-  }
-  else {
-    SimpleSSD::panic("Event %" PRIu64 " does not exists", eid);
+  if (data.scheduled) {
+    eventQueue->remove(eid);
+    descheduleCount++;
+
+    data.scheduled = false;
   }
 }
 
 bool Engine::isScheduled(SimpleSSD::Event eid, uint64_t *pTick) {
-  bool ret = false;
-  auto iter = eventList.find(eid);
+  auto &data = getEventData(eid);
 
-  if (iter != eventList.end()) {
-    ret = isEventExist(eid, pTick);
-  }
-  else {
-    SimpleSSD::panic("Event %" PRIu64 " does not exists", eid);
+  if (data.scheduled && pTick) {
+    *pTick = data.tick;
   }
 
-  return ret;
+  return data.scheduled;
 }
 
 void Engine::deallocateEvent(SimpleSSD::Event eid) {
-  auto iter = eventList.find(eid);
+  auto &data = getEventData(eid);
+
+  if (data.scheduled) {
+    eventQueue->remove(eid);
+    descheduleCount++;
+  }
+
+  data.func = nullptr;
+  data.allocated = false;
+  data.scheduled = false;
 
-  if (iter != eventList.end()) {
-    removeEvent(eid);
-    eventList.erase(iter);
+  freeList.push_back(eid);
+}
+
+void Engine::invoke(EventData &data, uint64_t tick) {
+  if (profiler) {
+    // Callback may deallocate and reuse its own slot
+    uint32_t id = data.profile;
+    auto begin = std::chrono::steady_clock::now();
+
+    data.func(tick);
+
+    auto end = std::chrono::steady_clock::now();
+
+    profiler->record(
+        id, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                end - begin)
+                .count());
   }
   else {
-    SimpleSSD::panic("Event %" PRIu64 " does not exists", eid);
+    data.func(tick);
   }
 }
 
+bool Engine::getNextTick(uint64_t &tick) {
+  SimpleSSD::Event eid;
+
+  return eventQueue->front(eid, tick);
+}
+
 bool Engine::doNextEvent() {
+  SimpleSSD::Event eid;
   uint64_t tickCopy;
 
   if (forceStop) {
     return false;
   }
 
-  if (eventQueue.size() > 0) {
-    auto &now = eventQueue.front();
+  if (eventQueue->front(eid, tickCopy)) {
+    if (eventHandled > 0 && simTick == tickCopy) {
+      collisionCount++;
+    }
 
-    {
-      std::lock_guard<std::mutex> guard(mTick);
+    simTick = tickCopy;
 
-      simTick = now.second;
-      tickCopy = simTick;
-    }
+    auto &data = eventList[eid];
 
-    auto iter = eventList.find(now.first);
+    queueLength.add(eventQueue->size());
+    eventQueue->pop();
+    data.scheduled = false;
+    invoke(data, tickCopy);
 
-    eventQueue.pop_front();
+    eventHandled++;
 
-    if (iter != eventList.end()) {
-      iter->second(tickCopy);
-    }
-    else {
-      SimpleSSD::panic("Event %" PRIu64 " does not exists", now.first);
-    }
+    auto &local = telemetry.data();
 
-    {
-      std::lock_guard<std::mutex> guard(m);
-      eventHandled++;
-    }
+    local.tick = simTick;
+    local.eventHandled++;
+    telemetry.publish();
 
     return true;
   }
@@ -226,28 +250,122 @@ bool Engine::doNextEvent() {
   return false;
 }
 
+bool Engine::doNextBatch() {
+  SimpleSSD::Event eid;
+  uint64_t tickCopy;
+  uint64_t next;
+  uint64_t handled = 0;
+
+  if (forceStop) {
+    return false;
+  }
+
+  if (!eventQueue->front(eid, tickCopy)) {
+    return false;
+  }
+
+  if (eventHandled > 0 && simTick == tickCopy) {
+    collisionCount++;
+  }
+
+  simTick = tickCopy;
+
+  // Handle all events at current tick, including events scheduled to current
+  // tick by callbacks. Event queue pops events in insertion order.
+  do {
+    auto &data = eventList[eid];
+
+    queueLength.add(eventQueue->size());
+    eventQueue->pop();
+    data.scheduled = false;
+    invoke(data, tickCopy);
+
+    handled++;
+  } while (!forceStop && eventQueue->front(eid, next) && next == tickCopy);
+
+  eventHandled += handled;
+  collisionCount += handled - 1;
+
+  auto &local = telemetry.data();
+
+  local.tick = simTick;
+  local.eventHandled += handled;
+  telemetry.publish();
+
+  return true;
+}
+
 void Engine::stopEngine() {
   forceStop = true;
 }
 
+void Engine::resumeEngine() {
+  forceStop = false;
+}
+
+void Engine::resetStats() {
+  eventHandled = 0;
+  scheduleCount = 0;
+  rescheduleCount = 0;
+  sameTickCount = 0;
+  descheduleCount = 0;
+  pastScheduleCount = 0;
+  collisionCount = 0;
+  queueLength.reset();
+  distance.reset();
+
+  if (profiler) {
+    profiler->reset();
+  }
+
+  watch.start();
+}
+
 void Engine::printStats(std::ostream &out) {
   watch.stop();
 
   double duration = watch.getDuration();
 
   out << "*** Statistics of Event Engine ***" << std::endl;
-  {
-    std::lock_guard<std::mutex> guard(mTick);
-
-    out << "Simulation Tick (ps): " << simTick << std::endl;
-  }
+  out << "Simulation Tick (ps): " << simTick << std::endl;
   out << "Host time duration (sec): " << std::to_string(duration) << std::endl;
   out << "Event handled: " << eventHandled << " ("
       << std::to_string(eventHandled / duration) << " ops)" << std::endl;
+  out << "Event scheduled: " << scheduleCount
+      << ", rescheduled: " << rescheduleCount
+      << " (same tick: " << sameTickCount
+      << "), descheduled: " << descheduleCount << std::endl;
+  out << "Event scheduled in the past: " << pastScheduleCount << std::endl;
+  out << "Event dispatched at same tick: " << collisionCount << std::endl;
+  printHistogram(out, "Queue length", queueLength, "");
+  printHistogram(out, "Scheduling distance", distance, " ps");
   out << "*** End of statistics ***" << std::endl;
+
+  if (profiler) {
+    profiler->printStats(out);
+  }
+}
+
+void Engine::printHistogram(std::ostream &out, const char *name,
+                            Histogram &hist, const char *unit) {
+  out << name << ": min=" << hist.getMin()
+      << ", avg=" << std::to_string(hist.getMean())
+      << ", p50=" << hist.getPercentile(50.)
+      << ", p99=" << hist.getPercentile(99.) << ", max=" << hist.getMax()
+      << std::endl;
+  hist.print(out, unit);
+}
+
+void Engine::printProfile(std::ostream &out) {
+  if (profiler) {
+    profiler->dumpFolded(out);
+  }
+}
+
+TelemetryData &Engine::getTelemetry() {
+  return telemetry.data();
 }
 
-void Engine::getStat(uint64_t &val) {
-  std::lock_guard<std::mutex> guard(m);
-  val = eventHandled;
+void Engine::readTelemetry(TelemetryData &data) {
+  telemetry.read(data);
 }
@@ -22,49 +22,110 @@
 #ifndef __SIM_ENGINE__
 #define __SIM_ENGINE__
 
+#include <deque>
 #include <iostream>
-#include <list>
-#include <mutex>
-#include <thread>
-#include <unordered_map>
+#include <vector>
 
+#include "sim/event_queue.hh"
+#include "sim/global_config.hh"
+#include "sim/profiler.hh"
+#include "sim/telemetry.hh"
 #include "simplessd/sim/simulator.hh"
+#include "util/delegate.hh"
+#include "util/histogram.hh"
 #include "util/stopwatch.hh"
 
 class Engine : public SimpleSSD::Simulator {
  private:
-  std::mutex mTick;
+  // Large enough to hold SimpleSSD::EventFunction from SimpleSSD
+  typedef Delegate<void(uint64_t), sizeof(SimpleSSD::EventFunction)> Callback;
+
+  typedef struct _EventData {
+    Callback func;
+    uint64_t tick;  // Valid only when scheduled
+    uint32_t profile;  // Valid only when profiler enabled
+    bool allocated;
+    bool scheduled;
+
+    _EventData() : tick(0), profile(0), allocated(false), scheduled(false) {}
+  } EventData;
+
   uint64_t simTick;
-  SimpleSSD::Event counter;
   bool forceStop;
-  std::unordered_map<SimpleSSD::Event, SimpleSSD::EventFunction> eventList;
-  std::list<std::pair<SimpleSSD::Event, uint64_t>> eventQueue;
+
+  // Indexed by event ID. Element references must stay valid while callback
+  // is running (callback may allocate new event), so deque is used here.
+  std::deque<EventData> eventList;
+  std::vector<SimpleSSD::Event> freeList;
+  EventQueue *eventQueue;
 
   Stopwatch watch;
 
-  std::mutex m;
   uint64_t eventHandled;
+  Telemetry telemetry;
+
+  Profiler *profiler;  // nullptr when profiling disabled
+
+  // Statistics
+  uint64_t scheduleCount;      // Scheduled while not scheduled
+  uint64_t rescheduleCount;    // Moved to another tick while scheduled
+  uint64_t sameTickCount;      // Rescheduled to same tick (ignored)
+  uint64_t descheduleCount;    // Descheduled or deallocated while scheduled
+  uint64_t pastScheduleCount;  // Scheduled before current tick
+  uint64_t collisionCount;     // Dispatched at same tick with previous event
+  Histogram queueLength;       // Sampled at every dispatch
+  Histogram distance;          // Scheduled tick - current tick
 
-  bool insertEvent(SimpleSSD::Event, uint64_t, uint64_t * = nullptr);
-  bool removeEvent(SimpleSSD::Event);
-  bool isEventExist(SimpleSSD::Event, uint64_t * = nullptr);
+  EventData &getEventData(SimpleSSD::Event);
+  SimpleSSD::Event allocate(Callback &&, uint32_t);
+  void invoke(EventData &, uint64_t);
+  void printHistogram(std::ostream &, const char *, Histogram &, const char *);
+
+  uint32_t profileID(const std::type_info &type) {
+    return profiler ? profiler->registerEvent(type) : 0;
+  }
+  uint32_t profileID(const char *name) {
+    return profiler ? profiler->registerEvent(name) : 0;
+  }
 
  public:
-  Engine();
+  Engine(EVENT_QUEUE = EVENT_QUEUE_HEAP, bool = false);
   ~Engine();
 
   uint64_t getCurrentTick() override;
 
   SimpleSSD::Event allocateEvent(SimpleSSD::EventFunction) override;
+
+  // Store callable directly without wrapping it in std::function
+  template <typename F>
+  SimpleSSD::Event allocateEvent(F &&func) {
+    return allocate(Callback(std::forward<F>(func)), profileID(typeid(F)));
+  }
+
+  // Name is used as event name in profiler output
+  template <typename F>
+  SimpleSSD::Event allocateEvent(F &&func, const char *name) {
+    return allocate(Callback(std::forward<F>(func)), profileID(name));
+  }
+
   void scheduleEvent(SimpleSSD::Event, uint64_t) override;
   void descheduleEvent(SimpleSSD::Event) override;
   bool isScheduled(SimpleSSD::Event, uint64_t * = nullptr) override;
   void deallocateEvent(SimpleSSD::Event) override;
 
+  bool getNextTick(uint64_t &);
   bool doNextEvent();
+  bool doNextBatch();
   void stopEngine();
+  void resumeEngine();
+  bool isStopped() { return forceStop; }
   void printStats(std::ostream &);
-  void getStat(uint64_t &);
+  void resetStats();
+  void printProfile(std::ostream &);
+
+  // Simulation thread updates and engine publishes it after each event
+  TelemetryData &getTelemetry();
+  void readTelemetry(TelemetryData &);
 };
 
 #endif
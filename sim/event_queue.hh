@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_EVENT_QUEUE__
+#define __SIM_EVENT_QUEUE__
+
+#include <cinttypes>
+
+#include "simplessd/sim/simulator.hh"
+
+// Pending event queue of Engine
+// Events are popped in order of scheduled tick. Events scheduled at same tick
+// are popped in insertion order.
+class EventQueue {
+ public:
+  EventQueue() {}
+  virtual ~EventQueue() {}
+
+  // Returns true if event was already scheduled at different tick (moved)
+  virtual bool insert(SimpleSSD::Event, uint64_t, uint64_t * = nullptr) = 0;
+  virtual bool remove(SimpleSSD::Event) = 0;
+  virtual bool find(SimpleSSD::Event, uint64_t * = nullptr) = 0;
+
+  virtual bool empty() = 0;
+  virtual uint64_t size() = 0;
+  virtual bool front(SimpleSSD::Event &, uint64_t &) = 0;
+  virtual void pop() = 0;
+};
+
+#endif
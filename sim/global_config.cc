@@ -19,6 +19,7 @@
 
 #include "sim/global_config.hh"
 
+#include "bil/latency_log.hh"
 #include "simplessd/sim/trace.hh"
 #include "util/convert.hh"
 
@@ -27,18 +28,70 @@ const char NAME_LOG_PERIOD[] = "LogPeriod";
 const char NAME_LOG_FILE[] = "LogFile";
 const char NAME_DEBUG_LOG_FILE[] = "DebugLogFile";
 const char NAME_LATENCY_LOG_FILE[] = "LatencyLogFile";
+const char NAME_LATENCY_LOG_FORMAT[] = "LatencyLogFormat";
+const char NAME_LATENCY_LOG_SAMPLING[] = "LatencyLogSampling";
+const char NAME_LATENCY_BREAKDOWN[] = "LatencyBreakdown";
 const char NAME_PROGRESS_PERIOD[] = "ProgressPeriod";
 const char NAME_INTERFACE[] = "Interface";
 const char NAME_SCHEDULER[] = "Scheduler";
+const char NAME_SCHEDULER_DEPTH[] = "SchedulerDepth";
+const char NAME_DEADLINE_READ_EXPIRE[] = "DeadlineReadExpire";
+const char NAME_DEADLINE_WRITE_EXPIRE[] = "DeadlineWriteExpire";
+const char NAME_DEADLINE_WRITES_STARVED[] = "DeadlineWritesStarved";
+const char NAME_DEADLINE_FIFO_BATCH[] = "DeadlineFifoBatch";
+const char NAME_KYBER_READ_LATENCY[] = "KyberReadLatency";
+const char NAME_KYBER_WRITE_LATENCY[] = "KyberWriteLatency";
+const char NAME_PLUG_WINDOW[] = "PlugWindow";
+const char NAME_MAX_REQUEST_SIZE[] = "MaxRequestSize";
 const char NAME_SUBMISSION_LATENCY[] = "SubmissionLatency";
 const char NAME_COMPLETION_LATENCY[] = "CompletionLatency";
+const char NAME_EVENT_QUEUE[] = "EventQueue";
+const char NAME_EVENT_PROFILE[] = "EventProfile";
+const char NAME_EVENT_PROFILE_FILE[] = "EventProfileFile";
+const char NAME_DEVICE_COUNT[] = "DeviceCount";
+const char NAME_STRIPE_SIZE[] = "StripeSize";
+const char NAME_PRECONDITION_MODE[] = "PreconditionMode";
+const char NAME_PRECONDITION_FILL[] = "PreconditionFill";
+const char NAME_PRECONDITION_RANDOM[] = "PreconditionRandom";
+const char NAME_PRECONDITION_BLOCK_SIZE[] = "PreconditionBlockSize";
+const char NAME_PRECONDITION_DEPTH[] = "PreconditionDepth";
+const char NAME_SAMPLING_PERIOD[] = "SamplingPeriod";
+const char NAME_SAMPLING_WINDOW[] = "SamplingWindow";
+const char NAME_SWEEP_JOBS[] = "SweepJobs";
+const char NAME_DIFFERENTIAL_CONFIG[] = "DifferentialConfig";
 
 Config::Config() {
   mode = MODE_REQUEST_GENERATOR;
   logPeriod = 0;
+  latencyFormat = 0;
+  latencySampling = 1;
+  latencyBreakdown = false;
   progressPeriod = 0;
   interface = INTERFACE_NVME;
   scheduler = SCHEDULER_NOOP;
+  schedulerDepth = 64;
+  deadlineReadExpire = 500000000000;    // 500ms
+  deadlineWriteExpire = 5000000000000;  // 5s
+  deadlineWritesStarved = 2;
+  deadlineFifoBatch = 16;
+  kyberReadLatency = 2000000000;    // 2ms
+  kyberWriteLatency = 10000000000;  // 10ms
+  plugWindow = 0;
+  maxRequestSize = 524288;
+  submissionLatency = 0;
+  completionLatency = 0;
+  eventQueue = EVENT_QUEUE_HEAP;
+  eventProfile = false;
+  deviceCount = 1;
+  stripeSize = 131072;
+  preconditionMode = PRECONDITION_IO;
+  preconditionFill = 0.f;
+  preconditionRandom = 0.f;
+  preconditionBlockSize = 4096;
+  preconditionDepth = 32;
+  samplingPeriod = 0;
+  samplingWindow = 0;
+  sweepJobs = 0;
 }
 
 bool Config::setConfig(const char *name, const char *value) {
@@ -59,6 +112,15 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_LATENCY_LOG_FILE)) {
     latencyFile = value;
   }
+  else if (MATCH_NAME(NAME_LATENCY_LOG_FORMAT)) {
+    latencyFormat = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_LATENCY_LOG_SAMPLING)) {
+    latencySampling = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_LATENCY_BREAKDOWN)) {
+    latencyBreakdown = convertBoolean(value);
+  }
   else if (MATCH_NAME(NAME_PROGRESS_PERIOD)) {
     progressPeriod = strtoul(value, nullptr, 10);
   }
@@ -68,12 +130,81 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_SCHEDULER)) {
     scheduler = (SCHEDULER)strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_SCHEDULER_DEPTH)) {
+    schedulerDepth = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_DEADLINE_READ_EXPIRE)) {
+    deadlineReadExpire = convertTime(value);
+  }
+  else if (MATCH_NAME(NAME_DEADLINE_WRITE_EXPIRE)) {
+    deadlineWriteExpire = convertTime(value);
+  }
+  else if (MATCH_NAME(NAME_DEADLINE_WRITES_STARVED)) {
+    deadlineWritesStarved = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_DEADLINE_FIFO_BATCH)) {
+    deadlineFifoBatch = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_KYBER_READ_LATENCY)) {
+    kyberReadLatency = convertTime(value);
+  }
+  else if (MATCH_NAME(NAME_KYBER_WRITE_LATENCY)) {
+    kyberWriteLatency = convertTime(value);
+  }
+  else if (MATCH_NAME(NAME_PLUG_WINDOW)) {
+    plugWindow = convertTime(value);
+  }
+  else if (MATCH_NAME(NAME_MAX_REQUEST_SIZE)) {
+    maxRequestSize = convertInteger(value);
+  }
   else if (MATCH_NAME(NAME_SUBMISSION_LATENCY)) {
     submissionLatency = convertTime(value);
   }
   else if (MATCH_NAME(NAME_COMPLETION_LATENCY)) {
     completionLatency = convertTime(value);
   }
+  else if (MATCH_NAME(NAME_EVENT_QUEUE)) {
+    eventQueue = (EVENT_QUEUE)strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_EVENT_PROFILE)) {
+    eventProfile = convertBoolean(value);
+  }
+  else if (MATCH_NAME(NAME_EVENT_PROFILE_FILE)) {
+    eventProfileFile = value;
+  }
+  else if (MATCH_NAME(NAME_DEVICE_COUNT)) {
+    deviceCount = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_STRIPE_SIZE)) {
+    stripeSize = convertInteger(value);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_MODE)) {
+    preconditionMode = (PRECONDITION_MODE)strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_FILL)) {
+    preconditionFill = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_RANDOM)) {
+    preconditionRandom = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_BLOCK_SIZE)) {
+    preconditionBlockSize = convertInteger(value);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_DEPTH)) {
+    preconditionDepth = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SAMPLING_PERIOD)) {
+    samplingPeriod = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SAMPLING_WINDOW)) {
+    samplingWindow = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SWEEP_JOBS)) {
+    sweepJobs = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_DIFFERENTIAL_CONFIG)) {
+    differentialConfig = value;
+  }
   else {
     ret = false;
   }
@@ -88,6 +219,63 @@ void Config::update() {
   if (interface >= INTERFACE_NUM) {
     SimpleSSD::panic("Invalid interface");
   }
+  if (scheduler >= SCHEDULER_NUM) {
+    SimpleSSD::panic("Invalid I/O scheduler");
+  }
+  if (schedulerDepth == 0) {
+    SimpleSSD::panic("Invalid scheduler depth");
+  }
+  if (deadlineFifoBatch == 0) {
+    SimpleSSD::panic("Invalid mq-deadline FIFO batch");
+  }
+  if (kyberReadLatency == 0 || kyberWriteLatency == 0) {
+    SimpleSSD::panic("Invalid Kyber target latency");
+  }
+  if (maxRequestSize == 0) {
+    SimpleSSD::panic("Invalid maximum request size");
+  }
+  if (eventQueue >= EVENT_QUEUE_NUM) {
+    SimpleSSD::panic("Invalid event queue");
+  }
+  if (latencyFormat >= BIL::LOG_FORMAT_NUM) {
+    SimpleSSD::panic("Invalid latency log format");
+  }
+  if (latencySampling == 0) {
+    SimpleSSD::panic("Invalid latency log sampling");
+  }
+  if (preconditionFill < 0.f || preconditionRandom < 0.f) {
+    SimpleSSD::panic("Invalid precondition amount");
+  }
+  if (preconditionMode >= PRECONDITION_NUM) {
+    SimpleSSD::panic("Invalid precondition mode");
+  }
+  if (preconditionMode == PRECONDITION_FTL &&
+      (preconditionFill > 1.f || preconditionRandom > 1.f)) {
+    SimpleSSD::panic("FTL precondition ratio should be in [0, 1]");
+  }
+  if (preconditionBlockSize == 0 || preconditionDepth == 0) {
+    SimpleSSD::panic("Invalid precondition block size or depth");
+  }
+  if (samplingPeriod > 0 &&
+      (samplingWindow == 0 || samplingWindow > samplingPeriod)) {
+    SimpleSSD::panic("Invalid sampling window");
+  }
+  if (deviceCount == 0) {
+    SimpleSSD::panic("Invalid device count");
+  }
+  if (deviceCount > 1 && differentialConfig.length() > 0) {
+    SimpleSSD::panic("Differential mode is not supported in multi-device "
+                     "mode");
+  }
+  if (deviceCount > 1) {
+    if (stripeSize == 0 || stripeSize % 512 != 0) {
+      SimpleSSD::panic("Stripe size should be multiple of 512");
+    }
+    if (completionLatency == 0) {
+      SimpleSSD::panic("Multi-device mode requires non-zero completion "
+                       "latency");
+    }
+  }
 }
 
 uint64_t Config::readUint(uint32_t idx) {
@@ -100,6 +288,12 @@ uint64_t Config::readUint(uint32_t idx) {
     case GLOBAL_LOG_PERIOD:
       ret = logPeriod;
       break;
+    case GLOBAL_LATENCY_LOG_FORMAT:
+      ret = latencyFormat;
+      break;
+    case GLOBAL_LATENCY_LOG_SAMPLING:
+      ret = latencySampling;
+      break;
     case GLOBAL_PROGRESS_PERIOD:
       ret = progressPeriod;
       break;
@@ -109,12 +303,81 @@ uint64_t Config::readUint(uint32_t idx) {
     case GLOBAL_SCHEDULER:
       ret = scheduler;
       break;
+    case GLOBAL_SCHEDULER_DEPTH:
+      ret = schedulerDepth;
+      break;
+    case GLOBAL_DEADLINE_READ_EXPIRE:
+      ret = deadlineReadExpire;
+      break;
+    case GLOBAL_DEADLINE_WRITE_EXPIRE:
+      ret = deadlineWriteExpire;
+      break;
+    case GLOBAL_DEADLINE_WRITES_STARVED:
+      ret = deadlineWritesStarved;
+      break;
+    case GLOBAL_DEADLINE_FIFO_BATCH:
+      ret = deadlineFifoBatch;
+      break;
+    case GLOBAL_KYBER_READ_LATENCY:
+      ret = kyberReadLatency;
+      break;
+    case GLOBAL_KYBER_WRITE_LATENCY:
+      ret = kyberWriteLatency;
+      break;
+    case GLOBAL_PLUG_WINDOW:
+      ret = plugWindow;
+      break;
+    case GLOBAL_MAX_REQUEST_SIZE:
+      ret = maxRequestSize;
+      break;
     case GLOBAL_SUBMISSION_LATENCY:
       ret = submissionLatency;
       break;
     case GLOBAL_COMPLETION_LATENCY:
       ret = completionLatency;
       break;
+    case GLOBAL_EVENT_QUEUE:
+      ret = eventQueue;
+      break;
+    case GLOBAL_DEVICE_COUNT:
+      ret = deviceCount;
+      break;
+    case GLOBAL_STRIPE_SIZE:
+      ret = stripeSize;
+      break;
+    case GLOBAL_PRECONDITION_MODE:
+      ret = preconditionMode;
+      break;
+    case GLOBAL_PRECONDITION_BLOCK_SIZE:
+      ret = preconditionBlockSize;
+      break;
+    case GLOBAL_PRECONDITION_DEPTH:
+      ret = preconditionDepth;
+      break;
+    case GLOBAL_SAMPLING_PERIOD:
+      ret = samplingPeriod;
+      break;
+    case GLOBAL_SAMPLING_WINDOW:
+      ret = samplingWindow;
+      break;
+    case GLOBAL_SWEEP_JOBS:
+      ret = sweepJobs;
+      break;
+  }
+
+  return ret;
+}
+
+float Config::readFloat(uint32_t idx) {
+  float ret = 0.f;
+
+  switch (idx) {
+    case GLOBAL_PRECONDITION_FILL:
+      ret = preconditionFill;
+      break;
+    case GLOBAL_PRECONDITION_RANDOM:
+      ret = preconditionRandom;
+      break;
   }
 
   return ret;
@@ -133,6 +396,27 @@ std::string Config::readString(uint32_t idx) {
     case GLOBAL_LATENCY_LOG_FILE:
       ret = latencyFile;
       break;
+    case GLOBAL_EVENT_PROFILE_FILE:
+      ret = eventProfileFile;
+      break;
+    case GLOBAL_DIFFERENTIAL_CONFIG:
+      ret = differentialConfig;
+      break;
+  }
+
+  return ret;
+}
+
+bool Config::readBoolean(uint32_t idx) {
+  bool ret = false;
+
+  switch (idx) {
+    case GLOBAL_LATENCY_BREAKDOWN:
+      ret = latencyBreakdown;
+      break;
+    case GLOBAL_EVENT_PROFILE:
+      ret = eventProfile;
+      break;
   }
 
   return ret;
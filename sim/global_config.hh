@@ -30,13 +30,45 @@ typedef enum {
   GLOBAL_LOG_FILE,
   GLOBAL_DEBUG_LOG_FILE,
   GLOBAL_LATENCY_LOG_FILE,
+  GLOBAL_LATENCY_LOG_FORMAT,
+  GLOBAL_LATENCY_LOG_SAMPLING,
+  GLOBAL_LATENCY_BREAKDOWN,
   GLOBAL_PROGRESS_PERIOD,
   GLOBAL_INTERFACE,
   GLOBAL_SCHEDULER,
+  GLOBAL_SCHEDULER_DEPTH,
+  GLOBAL_DEADLINE_READ_EXPIRE,
+  GLOBAL_DEADLINE_WRITE_EXPIRE,
+  GLOBAL_DEADLINE_WRITES_STARVED,
+  GLOBAL_DEADLINE_FIFO_BATCH,
+  GLOBAL_KYBER_READ_LATENCY,
+  GLOBAL_KYBER_WRITE_LATENCY,
+  GLOBAL_PLUG_WINDOW,
+  GLOBAL_MAX_REQUEST_SIZE,
   GLOBAL_SUBMISSION_LATENCY,
   GLOBAL_COMPLETION_LATENCY,
+  GLOBAL_EVENT_QUEUE,
+  GLOBAL_EVENT_PROFILE,
+  GLOBAL_EVENT_PROFILE_FILE,
+  GLOBAL_DEVICE_COUNT,
+  GLOBAL_STRIPE_SIZE,
+  GLOBAL_PRECONDITION_MODE,
+  GLOBAL_PRECONDITION_FILL,
+  GLOBAL_PRECONDITION_RANDOM,
+  GLOBAL_PRECONDITION_BLOCK_SIZE,
+  GLOBAL_PRECONDITION_DEPTH,
+  GLOBAL_SAMPLING_PERIOD,
+  GLOBAL_SAMPLING_WINDOW,
+  GLOBAL_SWEEP_JOBS,
+  GLOBAL_DIFFERENTIAL_CONFIG,
 } GLOBAL_CONFIG;
 
+typedef enum {
+  PRECONDITION_IO,   // Write I/Os through whole stack in functional mode
+  PRECONDITION_FTL,  // Fill FTL of SimpleSSD at initialization
+  PRECONDITION_NUM,
+} PRECONDITION_MODE;
+
 typedef enum {
   MODE_REQUEST_GENERATOR,
   MODE_TRACE_REPLAYER,
@@ -53,9 +85,17 @@ typedef enum {
 
 typedef enum {
   SCHEDULER_NOOP,
+  SCHEDULER_DEADLINE,
+  SCHEDULER_KYBER,
   SCHEDULER_NUM,
 } SCHEDULER;
 
+typedef enum {
+  EVENT_QUEUE_HEAP,
+  EVENT_QUEUE_WHEEL,
+  EVENT_QUEUE_NUM,
+} EVENT_QUEUE;
+
 class Config : public SimpleSSD::BaseConfig {
  private:
   SIM_MODE mode;
@@ -63,11 +103,37 @@ class Config : public SimpleSSD::BaseConfig {
   std::string logFile;
   std::string logDebugFile;
   std::string latencyFile;
+  uint64_t latencyFormat;
+  uint64_t latencySampling;
+  bool latencyBreakdown;
   uint64_t progressPeriod;
   INTERFACE interface;
   SCHEDULER scheduler;
+  uint64_t schedulerDepth;
+  uint64_t deadlineReadExpire;
+  uint64_t deadlineWriteExpire;
+  uint64_t deadlineWritesStarved;
+  uint64_t deadlineFifoBatch;
+  uint64_t kyberReadLatency;
+  uint64_t kyberWriteLatency;
+  uint64_t plugWindow;
+  uint64_t maxRequestSize;
   uint64_t submissionLatency;
   uint64_t completionLatency;
+  EVENT_QUEUE eventQueue;
+  bool eventProfile;
+  std::string eventProfileFile;
+  uint64_t deviceCount;
+  uint64_t stripeSize;
+  PRECONDITION_MODE preconditionMode;
+  float preconditionFill;
+  float preconditionRandom;
+  uint64_t preconditionBlockSize;
+  uint64_t preconditionDepth;
+  uint64_t samplingPeriod;
+  uint64_t samplingWindow;
+  uint64_t sweepJobs;
+  std::string differentialConfig;
 
  public:
   Config();
@@ -76,7 +142,9 @@ class Config : public SimpleSSD::BaseConfig {
   void update() override;
 
   uint64_t readUint(uint32_t) override;
+  float readFloat(uint32_t) override;
   std::string readString(uint32_t) override;
+  bool readBoolean(uint32_t) override;
 };
 
 #endif
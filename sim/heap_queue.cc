@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/heap_queue.hh"
+
+#include <limits>
+
+#define HEAP_ARITY 4
+#define INVALID_POSITION std::numeric_limits<uint64_t>::max()
+
+HeapQueue::HeapQueue() : sequence(0) {}
+
+HeapQueue::~HeapQueue() {}
+
+bool HeapQueue::less(const Entry &a, const Entry &b) {
+  if (a.tick == b.tick) {
+    return a.order < b.order;
+  }
+
+  return a.tick < b.tick;
+}
+
+void HeapQueue::place(uint64_t idx, Entry &entry) {
+  heap[idx] = entry;
+  position[entry.eid] = idx;
+}
+
+void HeapQueue::siftUp(uint64_t idx) {
+  Entry entry = heap[idx];
+
+  while (idx > 0) {
+    uint64_t parent = (idx - 1) / HEAP_ARITY;
+
+    if (!less(entry, heap[parent])) {
+      break;
+    }
+
+    place(idx, heap[parent]);
+    idx = parent;
+  }
+
+  place(idx, entry);
+}
+
+void HeapQueue::siftDown(uint64_t idx) {
+  Entry entry = heap[idx];
+  uint64_t count = heap.size();
+
+  while (true) {
+    uint64_t child = idx * HEAP_ARITY + 1;
+    uint64_t last = child + HEAP_ARITY;
+    uint64_t min = idx;
+
+    if (child >= count) {
+      break;
+    }
+
+    if (last > count) {
+      last = count;
+    }
+
+    // Find smallest child
+    min = child;
+
+    for (child = child + 1; child < last; child++) {
+      if (less(heap[child], heap[min])) {
+        min = child;
+      }
+    }
+
+    if (!less(heap[min], entry)) {
+      break;
+    }
+
+    place(idx, heap[min]);
+    idx = min;
+  }
+
+  place(idx, entry);
+}
+
+void HeapQueue::update(uint64_t idx) {
+  if (idx > 0 && less(heap[idx], heap[(idx - 1) / HEAP_ARITY])) {
+    siftUp(idx);
+  }
+  else {
+    siftDown(idx);
+  }
+}
+
+void HeapQueue::erase(uint64_t idx) {
+  uint64_t last = heap.size() - 1;
+
+  position[heap[idx].eid] = INVALID_POSITION;
+
+  if (idx != last) {
+    place(idx, heap[last]);
+    heap.pop_back();
+    update(idx);
+  }
+  else {
+    heap.pop_back();
+  }
+}
+
+bool HeapQueue::insert(SimpleSSD::Event eid, uint64_t tick,
+                       uint64_t *pOldTick) {
+  if (eid >= position.size()) {
+    position.resize(eid + 1, INVALID_POSITION);
+  }
+
+  uint64_t idx = position[eid];
+
+  if (idx != INVALID_POSITION) {
+    Entry &entry = heap[idx];
+
+    if (pOldTick) {
+      *pOldTick = entry.tick;
+    }
+
+    if (entry.tick == tick) {
+      // Rescheduling to same tick. Ignore.
+      return false;
+    }
+
+    // Rescheduled event goes behind events already at new tick
+    entry.tick = tick;
+    entry.order = sequence++;
+
+    update(idx);
+
+    return true;
+  }
+
+  Entry entry;
+
+  entry.tick = tick;
+  entry.order = sequence++;
+  entry.eid = eid;
+
+  heap.push_back(entry);
+  position[eid] = heap.size() - 1;
+
+  siftUp(heap.size() - 1);
+
+  return false;
+}
+
+bool HeapQueue::remove(SimpleSSD::Event eid) {
+  if (eid >= position.size() || position[eid] == INVALID_POSITION) {
+    return false;
+  }
+
+  erase(position[eid]);
+
+  return true;
+}
+
+bool HeapQueue::find(SimpleSSD::Event eid, uint64_t *pTick) {
+  if (eid >= position.size() || position[eid] == INVALID_POSITION) {
+    return false;
+  }
+
+  if (pTick) {
+    *pTick = heap[position[eid]].tick;
+  }
+
+  return true;
+}
+
+bool HeapQueue::empty() {
+  return heap.empty();
+}
+
+uint64_t HeapQueue::size() {
+  return heap.size();
+}
+
+bool HeapQueue::front(SimpleSSD::Event &eid, uint64_t &tick) {
+  if (heap.empty()) {
+    return false;
+  }
+
+  eid = heap.front().eid;
+  tick = heap.front().tick;
+
+  return true;
+}
+
+void HeapQueue::pop() {
+  if (!heap.empty()) {
+    erase(0);
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_HEAP_QUEUE__
+#define __SIM_HEAP_QUEUE__
+
+#include <cinttypes>
+#include <vector>
+
+#include "sim/event_queue.hh"
+
+// Indexed 4-ary min-heap of scheduled events
+// Heap position of each event is indexed by event ID, so lookup is O(1) and
+// insert/remove/reschedule is O(log n).
+class HeapQueue : public EventQueue {
+ private:
+  typedef struct _Entry {
+    uint64_t tick;
+    uint64_t order;
+    SimpleSSD::Event eid;
+  } Entry;
+
+  std::vector<Entry> heap;
+  std::vector<uint64_t> position;  // Indexed by event ID
+  uint64_t sequence;
+
+  inline bool less(const Entry &, const Entry &);
+  void place(uint64_t, Entry &);
+  void siftUp(uint64_t);
+  void siftDown(uint64_t);
+  void update(uint64_t);
+  void erase(uint64_t);
+
+ public:
+  HeapQueue();
+  ~HeapQueue();
+
+  bool insert(SimpleSSD::Event, uint64_t, uint64_t * = nullptr) override;
+  bool remove(SimpleSSD::Event) override;
+  bool find(SimpleSSD::Event, uint64_t * = nullptr) override;
+
+  bool empty() override;
+  uint64_t size() override;
+  bool front(SimpleSSD::Event &, uint64_t &) override;
+  void pop() override;
+};
+
+#endif
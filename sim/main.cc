@@ -17,41 +17,80 @@
  * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <csignal>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+
+#ifndef _MSC_VER
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "bil/entry.hh"
+#include "igl/precondition/preconditioner.hh"
 #include "igl/request/request_generator.hh"
 #include "igl/trace/trace_replayer.hh"
-#include "sil/none/none.hh"
-#include "sil/nvme/nvme.hh"
+#include "igl/trace/trace_shard.hh"
+#include "sim/differential.hh"
 #include "sim/engine.hh"
 #include "sim/signal.hh"
-#include "simplessd/util/simplessd.hh"
+#include "sim/simulation.hh"
+#include "sim/sweep.hh"
+#include "util/mapped_file.hh"
+#include "util/pipe.hh"
 #include "util/print.hh"
 
 // Global objects
-Engine engine;
-ConfigReader simConfig;
-BIL::DriverInterface *pInterface = nullptr;
-BIL::BlockIOEntry *pBIOEntry = nullptr;
+Simulation *pSimulation = nullptr;
+Simulation *pCompare = nullptr;  // Device B of differential mode
+Differential *pDifferential = nullptr;
 IGL::IOGenerator *pIOGen = nullptr;
+IGL::IOGenerator *pPrecondition = nullptr;
 std::ostream *pLog = nullptr;
 std::ostream *pDebugLog = nullptr;
 std::ostream *pLatencyFile = nullptr;
+BIL::LatencyLog *pLatencyLog = nullptr;
 std::thread *pThread = nullptr;
 std::mutex killLock;
 SimpleSSD::Event statEvent;
-std::vector<SimpleSSD::Stats> statList;
+SimpleSSD::Event phaseEvent;
 std::ofstream logOut;
 std::ofstream debugLogOut;
 std::ofstream latencyFile;
+std::ofstream profileFile;
+std::function<void()> endCallback;
+std::function<void()> preconditionCallback;
+std::vector<std::string> experimentList;
+bool noLogPrintOnScreen = true;
+bool checkpointParent = false;
+IGL::TraceShard currentShard;
+std::string shardSuffix;  // Appended to output files of shard process
+std::string experimentSuffix;  // Appended to output files of experiment
+std::string logFilePath;       // Full path of output files, without
+std::string debugLogFilePath;  // experiment suffix
+std::string latencyFilePath;
+std::string profileFilePath;
+int shardPipe = -1;       // Valid only in shard process
+int sweepPipe = -1;       // Valid only in sweep point process
 
 // Declaration
 void cleanup(int);
 void statistics(uint64_t);
 void threadFunc(int);
+bool doNextBatch();
+IGL::IOGenerator *createIOGenerator();
+void startProgressThread();
+void stopProgressThread();
+void scheduleStatEvent(uint64_t);
+void endPrecondition();
+bool forkExperiments();
+bool reopenOutputFile(std::ofstream &, std::string &, std::ios::openmode);
+bool writeFillConfig(std::string &, std::string &, const char *);
+bool forkShards();
+bool forkSweep(Sweep &, std::string &, std::string &, std::string &);
 
 void joinPath(std::string &lhs, std::string &rhs) {
   if (rhs.front() == '/') {
@@ -71,33 +110,99 @@ int main(int argc, char *argv[]) {
   std::cout << "SimpleSSD Standalone v2.0" << std::endl;
 
   // Check argument
-  if (argc != 4) {
+  if (argc < 4) {
     std::cerr << " Invalid number of argument!" << std::endl;
     std::cerr << "  Usage: simplessd-standalone <Simulation configuration "
-                 "file> <SimpleSSD configuration file> <Output directory>"
+                 "file> <SimpleSSD configuration file> <Output directory> "
+                 "[<Experiment configuration file> ...]"
               << std::endl;
 
     return 1;
   }
 
+  std::string simConfigPath(argv[1]);
+  std::string ssdConfigPath(argv[2]);
+  std::string outputPath(argv[3]);
+
+  // Simulation of configuration file becomes warm-up phase, and each
+  // experiment continues from the state at the end of warm-up
+  // Output files of N-th experiment get .exp<N> suffix
+  for (int i = 4; i < argc; i++) {
+    experimentList.push_back(argv[i]);
+  }
+
   // Install signal handler
   installSignalHandler(cleanup);
 
+  // Create simulation context
+  pSimulation = new Simulation();
+
+  ConfigReader &config = pSimulation->getConfig();
+
+  // Parameter sweep - each point is simulated in its own process, and this
+  // process only collects results of points
+  Sweep sweep;
+
+  if (!sweep.init(simConfigPath, ssdConfigPath)) {
+    std::cerr << " Failed to open configuration file!" << std::endl;
+
+    return 2;
+  }
+
+  if (sweep.getParameterCount() > 0) {
+    if (experimentList.size() > 0) {
+      std::cerr << " Experiments are not supported in parameter sweep!"
+                << std::endl;
+
+      return 2;
+    }
+
+    if (!forkSweep(sweep, simConfigPath, ssdConfigPath, outputPath)) {
+      return 0;
+    }
+  }
+
   // Read simulation config file
-  if (!simConfig.init(argv[1])) {
+  if (!config.init(simConfigPath)) {
     std::cerr << " Failed to open simulation configuration file!" << std::endl;
 
     return 2;
   }
 
-  // Log setting
-  bool noLogPrintOnScreen = true;
+  if (experimentList.size() > 0 &&
+      config.readUint(CONFIG_GLOBAL, GLOBAL_DEVICE_COUNT) > 1) {
+    std::cerr << " Experiments are not supported in multi-device mode!"
+              << std::endl;
+
+    return 2;
+  }
+
+  // Sharded trace replay - each shard is simulated in its own process, and
+  // this process only merges results of shards
+  if (config.readUint(CONFIG_GLOBAL, GLOBAL_SIM_MODE) ==
+          MODE_TRACE_REPLAYER &&
+      config.readUint(CONFIG_TRACE, IGL::TRACE_SHARD_COUNT) > 1) {
+    if (experimentList.size() > 0 || sweepPipe >= 0) {
+      std::cerr << " Experiments and parameter sweep are not supported in "
+                   "sharded replay!"
+                << std::endl;
+
+      return 2;
+    }
+
+    if (!forkShards()) {
+      return 0;
+    }
+  }
 
-  std::string logPath = simConfig.readString(CONFIG_GLOBAL, GLOBAL_LOG_FILE);
+  // Log setting
+  std::string logPath = config.readString(CONFIG_GLOBAL, GLOBAL_LOG_FILE);
   std::string debugLogPath =
-      simConfig.readString(CONFIG_GLOBAL, GLOBAL_DEBUG_LOG_FILE);
+      config.readString(CONFIG_GLOBAL, GLOBAL_DEBUG_LOG_FILE);
   std::string latencyLogPath =
-      simConfig.readString(CONFIG_GLOBAL, GLOBAL_LATENCY_LOG_FILE);
+      config.readString(CONFIG_GLOBAL, GLOBAL_LATENCY_LOG_FILE);
+  std::string profilePath =
+      config.readString(CONFIG_GLOBAL, GLOBAL_EVENT_PROFILE_FILE);
 
   if (logPath.compare("STDOUT") == 0) {
     noLogPrintOnScreen = false;
@@ -108,9 +213,11 @@ int main(int argc, char *argv[]) {
     pLog = &std::cerr;
   }
   else if (logPath.length() != 0) {
-    std::string full(argv[3]);
+    std::string full(outputPath);
 
     joinPath(full, logPath);
+    full += shardSuffix;
+    logFilePath = full;
     logOut.open(full);
 
     if (!logOut.is_open()) {
@@ -131,9 +238,11 @@ int main(int argc, char *argv[]) {
     pDebugLog = &std::cerr;
   }
   else if (debugLogPath.length() != 0) {
-    std::string full(argv[3]);
+    std::string full(outputPath);
 
     joinPath(full, debugLogPath);
+    full += shardSuffix;
+    debugLogFilePath = full;
     debugLogOut.open(full);
 
     if (!debugLogOut.is_open()) {
@@ -146,10 +255,12 @@ int main(int argc, char *argv[]) {
   }
 
   if (latencyLogPath.length() != 0) {
-    std::string full(argv[3]);
+    std::string full(outputPath);
 
     joinPath(full, latencyLogPath);
-    latencyFile.open(full);
+    full += shardSuffix;
+    latencyFilePath = full;
+    latencyFile.open(full, std::ios::binary);
 
     if (!latencyFile.is_open()) {
       std::cerr << " Failed to open log file: " << full << std::endl;
@@ -160,104 +271,665 @@ int main(int argc, char *argv[]) {
     pLatencyFile = &latencyFile;
   }
 
-  // Initialize SimpleSSD
-  auto ssdConfig = initSimpleSSDEngine(&engine, pDebugLog, pDebugLog, argv[2]);
+  if (profilePath.length() != 0 &&
+      config.readBoolean(CONFIG_GLOBAL, GLOBAL_EVENT_PROFILE)) {
+    std::string full(outputPath);
 
-  // Create Driver
-  switch (simConfig.readUint(CONFIG_GLOBAL, GLOBAL_INTERFACE)) {
-    case INTERFACE_NONE:
-      pInterface = new SIL::None::Driver(engine, ssdConfig);
+    joinPath(full, profilePath);
+    full += shardSuffix;
+    profileFilePath = full;
+    profileFile.open(full);
 
-      break;
-    case INTERFACE_NVME:
-      pInterface = new SIL::NVMe::Driver(engine, ssdConfig);
+    if (!profileFile.is_open()) {
+      std::cerr << " Failed to open log file: " << full << std::endl;
 
-      break;
-    default:
-      std::cerr << " Undefined interface specified." << std::endl;
+      return 3;
+    }
+  }
 
-      return 4;
+  std::string compareConfigPath =
+      config.readString(CONFIG_GLOBAL, GLOBAL_DIFFERENTIAL_CONFIG);
+
+  // In differential mode, latency log contains both devices
+  if (pLatencyFile && compareConfigPath.length() == 0) {
+    pLatencyLog = new BIL::LatencyLog(
+        latencyFile,
+        (BIL::LOG_FORMAT)config.readUint(CONFIG_GLOBAL,
+                                         GLOBAL_LATENCY_LOG_FORMAT),
+        config.readUint(CONFIG_GLOBAL, GLOBAL_LATENCY_LOG_SAMPLING));
   }
 
-  // Create Block I/O Layer
-  pBIOEntry =
-      new BIL::BlockIOEntry(simConfig, engine, pInterface, pLatencyFile);
+  // FTL preconditioning is done by SimpleSSD itself while initializing FTL,
+  // so no I/O is simulated
+  bool ftlPrecondition =
+      config.readUint(CONFIG_GLOBAL, GLOBAL_PRECONDITION_MODE) ==
+          PRECONDITION_FTL &&
+      (config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_FILL) > 0.f ||
+       config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_RANDOM) > 0.f);
+
+  if (ftlPrecondition) {
+    if (!writeFillConfig(ssdConfigPath, outputPath, "simplessd_fill.cfg") ||
+        (compareConfigPath.length() > 0 &&
+         !writeFillConfig(compareConfigPath, outputPath,
+                          "simplessd_fill_b.cfg"))) {
+      std::cerr << " Failed to write FTL precondition configuration file!"
+                << std::endl;
 
-  std::function<void()> endCallback = []() {
-    // If stat printout is scheduled, delete it
-    if (simConfig.readUint(CONFIG_GLOBAL, GLOBAL_LOG_PERIOD) > 0) {
-      engine.descheduleEvent(statEvent);
+      return 3;
     }
+  }
+
+  // Create engine, driver and block I/O layer
+  if (!pSimulation->init(ssdConfigPath, pDebugLog, pLatencyLog)) {
+    std::cerr << " Undefined interface specified." << std::endl;
+
+    return 4;
+  }
+
+  if (compareConfigPath.length() > 0) {
+    pCompare = new Simulation();
+
+    if (!pCompare->getConfig().init(simConfigPath) ||
+        !pCompare->init(compareConfigPath)) {
+      std::cerr << " Failed to initialize device B of differential mode."
+                << std::endl;
+
+      return 4;
+    }
+
+    pDifferential = new Differential(*pSimulation, *pCompare, pLatencyFile);
+    pSimulation->activate();
+  }
+
+  endCallback = []() {
+    // If stat printout is scheduled, delete it
+    pSimulation->getEngine().descheduleEvent(statEvent);
 
     // Stop simulation
-    engine.stopEngine();
+    pSimulation->getEngine().stopEngine();
   };
 
   // Create I/O generator
-  switch (simConfig.readUint(CONFIG_GLOBAL, GLOBAL_SIM_MODE)) {
-    case MODE_REQUEST_GENERATOR:
-      pIOGen =
-          new IGL::RequestGenerator(engine, *pBIOEntry, endCallback, simConfig);
+  pIOGen = createIOGenerator();
 
-      break;
-    case MODE_TRACE_REPLAYER:
-      pIOGen =
-          new IGL::TraceReplayer(engine, *pBIOEntry, endCallback, simConfig);
+  if (pIOGen == nullptr) {
+    std::cerr << " Undefined simulation mode specified." << std::endl;
 
-      break;
-    default:
-      std::cerr << " Undefined simulation mode specified." << std::endl;
+    cleanup(0);
 
-      cleanup(0);
+    return 5;
+  }
 
-      return 5;
+  // Preconditioning runs before I/O generator in functional mode
+  if (!ftlPrecondition &&
+      (config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_FILL) > 0.f ||
+       config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_RANDOM) > 0.f)) {
+    // Preconditioner cannot be deleted inside of its own callback
+    preconditionCallback = []() {
+      auto &engine = pSimulation->getEngine();
+
+      engine.scheduleEvent(phaseEvent, engine.getCurrentTick());
+    };
+
+    pPrecondition =
+        new IGL::Preconditioner(pSimulation->getEngine(),
+                                pSimulation->getBlockIO(),
+                                preconditionCallback, config);
+    phaseEvent = pSimulation->getEngine().allocateEvent(
+        [](uint64_t) { endPrecondition(); });
   }
 
   std::function<void()> beginCallback = []() {
     uint64_t bytesize;
     uint32_t bs;
 
-    pInterface->getInfo(bytesize, bs);
-    pIOGen->init(bytesize, bs);
-    pIOGen->begin();
+    pSimulation->getInterface().getInfo(bytesize, bs);
+
+    if (pPrecondition) {
+      pSimulation->getBlockIO().setFunctionalMode(true);
+      pPrecondition->init(bytesize, bs);
+      pPrecondition->begin();
+    }
+    else {
+      pIOGen->init(bytesize, bs);
+      pIOGen->begin();
+    }
   };
 
   // Insert stat event
-  pInterface->initStats(statList);
-
-  if (simConfig.readUint(CONFIG_GLOBAL, GLOBAL_LOG_PERIOD) > 0) {
-    statEvent = engine.allocateEvent([](uint64_t tick) {
-      statistics(tick);
-
-      engine.scheduleEvent(
-          statEvent,
-          tick + simConfig.readUint(CONFIG_GLOBAL, GLOBAL_LOG_PERIOD) *
-                     1000000000ULL);
-    });
-    engine.scheduleEvent(
-        statEvent,
-        simConfig.readUint(CONFIG_GLOBAL, GLOBAL_LOG_PERIOD) * 1000000000ULL);
+  statEvent = pSimulation->getEngine().allocateEvent([](uint64_t tick) {
+    statistics(tick);
+    scheduleStatEvent(tick);
+  });
+
+  // Periodic log starts after preconditioning
+  if (pPrecondition == nullptr) {
+    scheduleStatEvent(0);
   }
 
   // Do Simulation
   std::cout << "********** Begin of simulation **********" << std::endl;
 
-  pInterface->init(beginCallback);
+  if (pDifferential) {
+    pDifferential->init(beginCallback);
+  }
+  else {
+    pSimulation->getInterface().init(beginCallback);
+  }
+
+  startProgressThread();
+
+  while (doNextBatch())
+    ;
+
+  // Continue simulation in each experiment process
+  if (experimentList.size() > 0 && forkExperiments()) {
+    while (doNextBatch())
+      ;
+  }
+
+  cleanup(0);
+
+  return 0;
+}
+
+bool doNextBatch() {
+  if (pDifferential) {
+    return pDifferential->doNextBatch();
+  }
+
+  return pSimulation->getEngine().doNextBatch();
+}
+
+IGL::IOGenerator *createIOGenerator() {
+  auto &engine = pSimulation->getEngine();
+  auto &bioEntry = pSimulation->getBlockIO();
+  auto &config = pSimulation->getConfig();
+
+  switch (config.readUint(CONFIG_GLOBAL, GLOBAL_SIM_MODE)) {
+    case MODE_REQUEST_GENERATOR:
+      return new IGL::RequestGenerator(engine, bioEntry, endCallback, config);
+    case MODE_TRACE_REPLAYER: {
+      auto pReplayer =
+          new IGL::TraceReplayer(engine, bioEntry, endCallback, config);
+
+      if (shardPipe >= 0) {
+        pReplayer->setShard(currentShard);
+      }
+
+      return pReplayer;
+    }
+    default:
+      return nullptr;
+  }
+}
 
-  if (noLogPrintOnScreen) {
-    int period = (int)simConfig.readUint(CONFIG_GLOBAL, GLOBAL_PROGRESS_PERIOD);
+void startProgressThread() {
+  // Shard and sweep point processes share one terminal
+  if (noLogPrintOnScreen && shardPipe < 0 && sweepPipe < 0) {
+    int period = (int)pSimulation->getConfig().readUint(
+        CONFIG_GLOBAL, GLOBAL_PROGRESS_PERIOD);
 
     if (period > 0) {
       pThread = new std::thread(threadFunc, period);
     }
   }
+}
 
-  while (engine.doNextEvent())
-    ;
+void stopProgressThread() {
+  if (pThread) {
+    killLock.lock();
 
-  cleanup(0);
+    pThread->join();
 
-  return 0;
+    delete pThread;
+    pThread = nullptr;
+
+    killLock.unlock();
+  }
+}
+
+void scheduleStatEvent(uint64_t tick) {
+  uint64_t period =
+      pSimulation->getConfig().readUint(CONFIG_GLOBAL, GLOBAL_LOG_PERIOD);
+
+  if (period > 0) {
+    pSimulation->getEngine().scheduleEvent(statEvent,
+                                           tick + period * 1000000000ULL);
+  }
+}
+
+void endPrecondition() {
+  uint64_t tick = pSimulation->getEngine().getCurrentTick();
+  uint64_t bytesize;
+  uint32_t bs;
+
+  // Erase progress
+  printf("\33[2K                                                           \r");
+
+  std::cout << "********** End of preconditioning @ tick " << tick
+            << " **********" << std::endl;
+  pPrecondition->printStats(std::cout);
+
+  delete pPrecondition;
+  pPrecondition = nullptr;
+
+  pSimulation->getEngine().deallocateEvent(phaseEvent);
+
+  // Statistics only cover I/O generator
+  pSimulation->getBlockIO().setFunctionalMode(false);
+  pSimulation->getBlockIO().resetStats();
+  pSimulation->getEngine().resetStats();
+
+  scheduleStatEvent(tick);
+
+  pSimulation->getInterface().getInfo(bytesize, bs);
+  pIOGen->init(bytesize, bs);
+  pIOGen->begin();
+}
+
+// Returns true in experiment process, false in warm-up process when all
+// experiments are finished
+bool forkExperiments() {
+#ifdef _MSC_VER
+  std::cerr << " Experiments are not supported on Windows!" << std::endl;
+
+  return false;
+#else
+  uint64_t tick = pSimulation->getEngine().getCurrentTick();
+  uint64_t bytesize;
+  uint32_t bs;
+  uint64_t index = 0;
+
+  // Thread is not duplicated by fork
+  stopProgressThread();
+
+  // Erase progress
+  printf("\33[2K                                                           \r");
+
+  std::cout << "********** End of warm-up @ tick " << tick << " **********"
+            << std::endl;
+  pIOGen->printStats(std::cout);
+
+  // Do not duplicate buffered output
+  fflush(stdout);
+  std::cout.flush();
+  std::cerr.flush();
+
+  if (pLog) {
+    pLog->flush();
+  }
+  if (pDebugLog) {
+    pDebugLog->flush();
+  }
+  if (pLatencyLog) {
+    pLatencyLog->suspend();
+  }
+  if (pLatencyFile) {
+    pLatencyFile->flush();
+  }
+
+  for (auto &file : experimentList) {
+    int pid = fork();
+
+    index++;
+
+    if (pid < 0) {
+      std::cerr << " Failed to create experiment process!" << std::endl;
+
+      break;
+    }
+    else if (pid > 0) {
+      int status;
+
+      waitpid(pid, &status, 0);
+
+      continue;
+    }
+
+    // Experiment process
+    // Overwrite configurations of warm-up with experiment configuration
+    if (!pSimulation->getConfig().init(file)) {
+      std::cerr << " Failed to open experiment configuration file: " << file
+                << std::endl;
+
+      exit(2);
+    }
+
+    // Output files of warm-up are kept, and each experiment writes its own
+    experimentSuffix = ".exp" + std::to_string(index);
+
+    if (!reopenOutputFile(logOut, logFilePath, std::ios::out) ||
+        !reopenOutputFile(debugLogOut, debugLogFilePath, std::ios::out) ||
+        !reopenOutputFile(latencyFile, latencyFilePath, std::ios::binary) ||
+        !reopenOutputFile(profileFile, profileFilePath, std::ios::out)) {
+      exit(3);
+    }
+
+    std::cout << "********** Begin of experiment " << file << " **********"
+              << std::endl;
+
+    delete pIOGen;
+    pIOGen = createIOGenerator();
+
+    if (pIOGen == nullptr) {
+      std::cerr << " Undefined simulation mode specified." << std::endl;
+
+      exit(5);
+    }
+
+    if (pLatencyLog) {
+      pLatencyLog->restart();
+    }
+
+    pSimulation->getBlockIO().resetStats();
+    pSimulation->getEngine().resetStats();
+    pSimulation->getEngine().resumeEngine();
+
+    scheduleStatEvent(tick);
+
+    pSimulation->getInterface().getInfo(bytesize, bs);
+    pIOGen->init(bytesize, bs);
+    pIOGen->begin();
+
+    startProgressThread();
+
+    return true;
+  }
+
+  checkpointParent = true;
+
+  return false;
+#endif
+}
+
+bool reopenOutputFile(std::ofstream &file, std::string &path,
+                      std::ios::openmode mode) {
+  if (!file.is_open()) {
+    return true;
+  }
+
+  file.close();
+  file.open(path + experimentSuffix, mode);
+
+  if (!file.is_open()) {
+    std::cerr << " Failed to open log file: " << path + experimentSuffix
+              << std::endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+// Copy SimpleSSD configuration file to output directory with FTL filling
+// parameters appended, and replace path with the copy
+bool writeFillConfig(std::string &path, std::string &outputPath,
+                     const char *name) {
+  auto &config = pSimulation->getConfig();
+  float fill = config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_FILL);
+  float random = config.readFloat(CONFIG_GLOBAL, GLOBAL_PRECONDITION_RANDOM);
+  std::string filename(name);
+  std::string full(outputPath);
+  std::ifstream in(path);
+
+  joinPath(full, filename);
+  full += shardSuffix;
+
+  std::ofstream out(full);
+
+  if (!in.is_open() || !out.is_open()) {
+    return false;
+  }
+
+  // Later keys override earlier ones of same name
+  if (in.peek() != std::ifstream::traits_type::eof()) {
+    out << in.rdbuf();
+  }
+
+  out << std::endl;
+  out << "# Appended by PreconditionMode = 1" << std::endl;
+  out << "[ftl]" << std::endl;
+  out << "FillingMode = " << (random > 0.f ? 1 : 0) << std::endl;
+  out << "FillRatio = " << fill << std::endl;
+  out << "InvalidPageRatio = " << random << std::endl;
+
+  if (!out.good()) {
+    return false;
+  }
+
+  path = full;
+
+  return true;
+}
+
+// Returns true in shard process, false in replay process when all shards are
+// finished
+bool forkShards() {
+#ifdef _MSC_VER
+  std::cerr << " Sharded replay is not supported on Windows! Replay whole "
+               "trace in this process."
+            << std::endl;
+
+  return true;
+#else
+  std::vector<IGL::TraceShard> shardList;
+  std::vector<IGL::ShardResult> resultList;
+  std::vector<int> pidList;
+  std::vector<int> pipeList;
+  auto &config = pSimulation->getConfig();
+  uint64_t count = config.readUint(CONFIG_TRACE, IGL::TRACE_SHARD_COUNT);
+
+  IGL::splitTrace(config.readString(CONFIG_TRACE, IGL::TRACE_FILE), count,
+                  config.readUint(CONFIG_TRACE, IGL::TRACE_SHARD_WARMUP),
+                  shardList);
+
+  std::cout << "********** Replay trace with " << count
+            << " shards **********" << std::endl;
+
+  // Do not duplicate buffered output
+  std::cout.flush();
+  std::cerr.flush();
+
+  for (uint64_t i = 0; i < count; i++) {
+    int fd[2];
+
+    if (pipe(fd) != 0) {
+      SimpleSSD::panic("Failed to create pipe");
+    }
+
+    int pid = fork();
+
+    if (pid < 0) {
+      SimpleSSD::panic("Failed to create shard process");
+    }
+    else if (pid == 0) {
+      for (auto in : pipeList) {
+        close(in);
+      }
+
+      close(fd[0]);
+
+      currentShard = shardList.at(i);
+      shardSuffix = "." + std::to_string(i);
+      shardPipe = fd[1];
+
+      return true;
+    }
+
+    close(fd[1]);
+
+    pidList.push_back(pid);
+    pipeList.push_back(fd[0]);
+  }
+
+  // Shard processes handle Ctrl+C and report partial results
+  signal(SIGINT, SIG_IGN);
+
+  resultList.resize(count);
+
+  // Failed shard does not abort others. All shards are waited for, and
+  // results of finished shards are merged.
+  for (uint64_t i = 0; i < count; i++) {
+    int status = 0;
+
+    if (!IGL::readShardResult(pipeList.at(i), resultList.at(i))) {
+      resultList.at(i).valid = false;
+    }
+
+    close(pipeList.at(i));
+    waitpid(pidList.at(i), &status, 0);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      resultList.at(i).valid = false;
+    }
+
+    if (!resultList.at(i).valid) {
+      std::cerr << " Shard " << i << " exited without result" << std::endl;
+    }
+  }
+
+  IGL::printShardResult(std::cout, shardList, resultList);
+
+  return false;
+#endif
+}
+
+// Returns true in sweep point process, false in sweep process when all points
+// are finished
+bool forkSweep(Sweep &sweep, std::string &simPath, std::string &ssdPath,
+               std::string &outputPath) {
+#ifdef _MSC_VER
+  std::cerr << " Parameter sweep is not supported on Windows!" << std::endl;
+
+  return false;
+#else
+  auto &config = pSimulation->getConfig();
+  uint64_t count = sweep.getPointCount();
+  uint64_t next = 0;
+  uint64_t finished = 0;
+  uint64_t jobs = 0;
+  std::vector<std::string> simList(count);
+  std::vector<std::string> ssdList(count);
+  std::vector<std::string> dirList(count);
+  std::vector<SweepResult> resultList(count);
+  std::vector<int> pipeList(count, -1);
+  std::unordered_map<int, uint64_t> pidList;  // PID -> point
+
+  for (uint64_t i = 0; i < count; i++) {
+    std::string name = "point" + std::to_string(i);
+
+    dirList[i] = outputPath;
+    joinPath(dirList[i], name);
+
+    if (!sweep.writePoint(i, dirList[i], simList[i], ssdList[i])) {
+      SimpleSSD::panic("Failed to write configuration of point %" PRIu64, i);
+    }
+
+    if (!config.init(simList[i])) {
+      SimpleSSD::panic("Failed to read configuration of point %" PRIu64, i);
+    }
+
+    // Trace is mapped once and shared by all point processes
+    if (config.readUint(CONFIG_GLOBAL, GLOBAL_SIM_MODE) ==
+        MODE_TRACE_REPLAYER) {
+      mapFile(config.readString(CONFIG_TRACE, IGL::TRACE_FILE));
+    }
+
+    if (jobs == 0) {
+      jobs = config.readUint(CONFIG_GLOBAL, GLOBAL_SWEEP_JOBS);
+    }
+  }
+
+  if (jobs == 0) {
+    jobs = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  std::cout << "********** Sweep " << sweep.getParameterCount()
+            << " parameters over " << count << " points with " << jobs
+            << " processes **********" << std::endl;
+
+  // Do not duplicate buffered output
+  std::cout.flush();
+  std::cerr.flush();
+
+  while (finished < count) {
+    if (next < count && pidList.size() < jobs) {
+      int fd[2];
+
+      if (pipe(fd) != 0) {
+        SimpleSSD::panic("Failed to create pipe");
+      }
+
+      int pid = fork();
+
+      if (pid < 0) {
+        SimpleSSD::panic("Failed to create sweep point process");
+      }
+      else if (pid == 0) {
+        for (auto &iter : pidList) {
+          close(pipeList[iter.second]);
+        }
+
+        close(fd[0]);
+
+        simPath = simList[next];
+        ssdPath = ssdList[next];
+        outputPath = dirList[next];
+        sweepPipe = fd[1];
+
+        // Point processes share one terminal
+        if (!freopen((outputPath + "/stdout.txt").c_str(), "w", stdout)) {
+          SimpleSSD::panic("Failed to redirect output of point %" PRIu64,
+                           next);
+        }
+
+        installSignalHandler(cleanup);
+
+        return true;
+      }
+
+      close(fd[1]);
+
+      pipeList[next] = fd[0];
+      pidList.emplace(pid, next++);
+
+      // Point processes handle Ctrl+C and report partial results
+      signal(SIGINT, SIG_IGN);
+
+      continue;
+    }
+
+    int status = 0;
+    auto iter = pidList.find(waitpid(-1, &status, 0));
+
+    if (iter == pidList.end()) {
+      continue;
+    }
+
+    uint64_t i = iter->second;
+
+    pidList.erase(iter);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        !readSweepResult(pipeList[i], resultList[i])) {
+      resultList[i].valid = false;
+    }
+
+    close(pipeList[i]);
+    finished++;
+
+    std::cout << "Point " << i
+              << (resultList[i].valid ? " finished" : " failed") << " ("
+              << finished << "/" << count << ")" << std::endl;
+  }
+
+  sweep.writeTable(outputPath, resultList);
+
+  std::cout << "********** End of sweep **********" << std::endl;
+
+  return false;
+#endif
 }
 
 void cleanup(int) {
@@ -265,26 +937,66 @@ void cleanup(int) {
 
   killLock.lock();
 
-  tick = engine.getCurrentTick();
+  // I/O generator is created after simulation context is initialized
+  tick = pIOGen ? pSimulation->getEngine().getCurrentTick() : 0;
 
   if (tick == 0) {
     // Exit program
     exit(0);
   }
 
-  // Print last statistics
-  statistics(tick);
+  // Statistics of warm-up are already printed
+  if (!checkpointParent) {
+    // Print last statistics
+    statistics(tick);
 
-  // Erase progress
-  printf("\33[2K                                                           \r");
+    // Erase progress
+    printf("\33[2K                                                           \r");
+  }
 
-  releaseSimpleSSDEngine();
+  if (shardPipe >= 0) {
+    // Replay process prints merged statistics
+    IGL::ShardResult result;
 
-  pIOGen->printStats(std::cout);
-  engine.printStats(std::cout);
+    ((IGL::TraceReplayer *)pIOGen)->getShardResult(result);
+    result.latency = pSimulation->getBlockIO().getLatency();
+
+    IGL::writeShardResult(shardPipe, result);
+  }
+  else if (!checkpointParent) {
+    if (sweepPipe >= 0) {
+      SweepResult result;
+      auto &bioEntry = pSimulation->getBlockIO();
+
+      result.duration = bioEntry.getDuration();
+      result.bytes = bioEntry.getBytes();
+      result.latency = bioEntry.getLatency();
+
+      writeSweepResult(sweepPipe, result);
+    }
+
+    if (pPrecondition) {
+      // Stopped while preconditioning
+      pPrecondition->printStats(std::cout);
+    }
+    else {
+      pIOGen->printStats(std::cout);
+    }
+
+    pSimulation->getEngine().printStats(std::cout);
+
+    if (pDifferential) {
+      pDifferential->printStats(std::cout);
+    }
+
+    if (profileFile.is_open()) {
+      pSimulation->getEngine().printProfile(profileFile);
+      profileFile.close();
+    }
+  }
 
   // Cleanup all here
-  delete pInterface;
+  delete pPrecondition;
   delete pIOGen;
 
   if (pThread) {
@@ -293,7 +1005,13 @@ void cleanup(int) {
     delete pThread;
   }
 
-  delete pBIOEntry;  // Used by progress thread
+  // SimpleSSD is released here
+  delete pDifferential;
+  delete pCompare;
+  delete pSimulation;
+
+  // Remaining records are written here
+  delete pLatencyLog;
 
   if (logOut.is_open()) {
     logOut.close();
@@ -308,16 +1026,12 @@ void cleanup(int) {
   exit(0);
 }
 
-void statistics(uint64_t tick) {
-  if (pLog == nullptr) {
-    return;
-  }
-
-  std::ostream &out = *pLog;
+void printStatList(std::ostream &out, Simulation &sim, std::string prefix) {
+  auto &statList = sim.getStatList();
   std::vector<double> stat;
   uint64_t count = 0;
 
-  pInterface->getStats(stat);
+  sim.getInterface().getStats(stat);
 
   count = statList.size();
 
@@ -327,24 +1041,48 @@ void statistics(uint64_t tick) {
     std::terminate();
   }
 
-  out << "Periodic log printout @ tick " << tick << std::endl;
-
   for (uint64_t i = 0; i < count; i++) {
-    print(out, statList[i].name, 40);
+    // CPU model is shared with device A, and already printed
+    if (pCompare == &sim && statList[i].name.compare(0, 4, "cpu.") == 0) {
+      continue;
+    }
+
+    print(out, prefix + statList[i].name, 40);
     out << "\t";
     print(out, stat[i], 20);
     out << "\t" << statList[i].desc << std::endl;
   }
+}
+
+void statistics(uint64_t tick) {
+  if (pLog == nullptr) {
+    return;
+  }
+
+  std::ostream &out = *pLog;
+
+  out << "Periodic log printout @ tick " << tick << std::endl;
+
+  printStatList(out, *pSimulation, "");
+  pSimulation->getBlockIO().printInterval(out);
+
+  // Statistics of device B are prefixed, except shared cpu.* statistics
+  if (pCompare) {
+    pCompare->activate();
+    printStatList(out, *pCompare, "B.");
+    pSimulation->activate();
+  }
 
   out << "End of log @ tick " << tick << std::endl;
 }
 
 void threadFunc(int tick) {
-  uint64_t current;
-  uint64_t old = 0;
-  float progress;
+  TelemetryData current;
+  TelemetryData old;
   auto duration = std::chrono::seconds(tick);
-  BIL::Progress data;
+
+  // Experiment process starts this thread in the middle of simulation
+  pSimulation->getEngine().readTelemetry(old);
 
   while (true) {
     std::this_thread::sleep_for(duration);
@@ -356,14 +1094,40 @@ void threadFunc(int tick) {
       break;
     }
 
-    engine.getStat(current);
-    pIOGen->getProgress(progress);
-    pBIOEntry->getProgress(data);
+    // Lock-free snapshot - never blocks simulation thread
+    pSimulation->getEngine().readTelemetry(current);
+
+    double simTime = (current.tick - old.tick) / 1000000000000.;
+    double ops = (double)(current.eventHandled - old.eventHandled) / tick;
+    double iops = 0.;
+    double bandwidth = 0.;
+    double latency = 0.;
+    double eta = -1.;
+    uint64_t ioCount = current.ioCount - old.ioCount;
+
+    if (simTime > 0.) {
+      iops = ioCount / simTime;
+      bandwidth = (current.ioBytes - old.ioBytes) / simTime;
+    }
+    if (ioCount > 0) {
+      latency = (double)(current.ioLatency - old.ioLatency) / ioCount;
+    }
+    if (current.progress > old.progress) {
+      eta = (1. - current.progress) * tick / (current.progress - old.progress);
+    }
+
+    printf("\33[2K*** Progress: %.2f%% (%lf ops) IOPS: %.0lf BW: %.0lf B/s "
+           "Avg. Lat: %.0lf ps Sim/Host: %.3e ETA: ",
+           current.progress * 100., ops, iops, bandwidth, latency,
+           simTime / tick);
+
+    if (eta < 0.) {
+      printf("N/A\r");
+    }
+    else {
+      printf("%.0lf s\r", eta);
+    }
 
-    printf("\33[2K*** Progress: %.2f%% (%lf ops) IOPS: %" PRIu64 " BW: %" PRIu64
-           " B/s Avg. Lat: %" PRIu64 " ps\r",
-           progress * 100.f, (double)(current - old) / tick, data.iops,
-           data.bandwidth, data.latency);
     fflush(stdout);
 
     old = current;
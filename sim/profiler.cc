@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/profiler.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "util/print.hh"
+
+Profiler::Profiler() {}
+
+uint32_t Profiler::getID(std::string &&name) {
+  auto iter = nameMap.find(name);
+
+  if (iter != nameMap.end()) {
+    return iter->second;
+  }
+
+  uint32_t id = (uint32_t)entryList.size();
+
+  nameMap.emplace(name, id);
+  entryList.emplace_back(std::move(name));
+
+  return id;
+}
+
+uint32_t Profiler::registerEvent(const std::type_info &type) {
+  std::string name;
+
+#ifdef __GNUG__
+  int status = 0;
+  char *demangled =
+      abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+
+  if (status == 0 && demangled) {
+    name = demangled;
+  }
+  else {
+    name = type.name();
+  }
+
+  free(demangled);
+#else
+  name = type.name();
+#endif
+
+  return getID(std::move(name));
+}
+
+uint32_t Profiler::registerEvent(const char *name) {
+  return getID(std::string(name));
+}
+
+void Profiler::printStats(std::ostream &out) {
+  std::vector<uint32_t> order;
+  uint64_t total = 0;
+
+  for (uint32_t i = 0; i < entryList.size(); i++) {
+    if (entryList[i].count > 0) {
+      order.push_back(i);
+      total += entryList[i].duration;
+    }
+  }
+
+  std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    return entryList[a].duration > entryList[b].duration;
+  });
+
+  out << "*** Event Profile ***" << std::endl;
+  print(out, "Host time (ms)", 16);
+  print(out, "Ratio (%)", 12);
+  print(out, "Count", 16);
+  print(out, "Avg. (ns)", 16);
+  out << "Event" << std::endl;
+
+  for (auto id : order) {
+    auto &entry = entryList[id];
+
+    print(out, entry.duration / 1000000., 16);
+    print(out, total > 0 ? entry.duration * 100. / total : 0., 12);
+    print(out, std::to_string(entry.count), 16);
+    print(out, (double)entry.duration / entry.count, 16);
+    out << entry.name << std::endl;
+  }
+
+  out << "*** End of profile ***" << std::endl;
+}
+
+void Profiler::reset() {
+  for (auto &entry : entryList) {
+    entry.count = 0;
+    entry.duration = 0;
+  }
+}
+
+void Profiler::dumpFolded(std::ostream &out) {
+  for (auto &entry : entryList) {
+    if (entry.count == 0) {
+      continue;
+    }
+
+    // ';' separates frames in folded format
+    std::string name = entry.name;
+
+    std::replace(name.begin(), name.end(), ';', ':');
+
+    out << "Engine;" << name << " " << entry.duration << std::endl;
+  }
+}
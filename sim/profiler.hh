@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_PROFILER__
+#define __SIM_PROFILER__
+
+#include <cinttypes>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+// Host CPU time profiler of event callbacks
+// Events are grouped by name - given explicitly at allocation, or demangled
+// type name of callback (which contains allocation site of lambda).
+class Profiler {
+ private:
+  typedef struct _Entry {
+    std::string name;
+    uint64_t count;
+    uint64_t duration;  // Host time in ns
+
+    _Entry(std::string &&n) : name(std::move(n)), count(0), duration(0) {}
+  } Entry;
+
+  std::vector<Entry> entryList;
+  std::unordered_map<std::string, uint32_t> nameMap;
+
+  uint32_t getID(std::string &&);
+
+ public:
+  Profiler();
+
+  uint32_t registerEvent(const std::type_info &);
+  uint32_t registerEvent(const char *);
+
+  void record(uint32_t id, uint64_t duration) {
+    auto &entry = entryList[id];
+
+    entry.count++;
+    entry.duration += duration;
+  }
+
+  void printStats(std::ostream &);
+  void reset();
+
+  // Folded stack format of flamegraph.pl (value in ns)
+  void dumpFolded(std::ostream &);
+};
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/simulation.hh"
+
+#include <map>
+
+#include "sil/none/none.hh"
+#include "sil/nvme/nvme.hh"
+#include "sil/parallel/parallel.hh"
+#include "simplessd/lib/inih/ini.h"
+#include "simplessd/sim/trace.hh"
+
+#ifdef _MSC_VER
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#endif
+
+// Engine of context which receives calls from SimpleSSD
+static Engine *activeEngine = nullptr;
+
+// Number of contexts which initialized SimpleSSD
+static uint32_t refCount = 0;
+
+// SimpleSSD configuration section applied to process-wide state (CPU model)
+// Only first context's values take effect, so other contexts must match.
+static const char SECTION_PROCESS[] = "cpu";
+
+typedef std::map<std::string, std::string> SectionData;
+
+// Process-wide section of first context
+static SectionData processSection;
+
+static int sectionHandler(void *context, const char *section,
+                          const char *name, const char *value) {
+  if (strcasecmp(section, SECTION_PROCESS) == 0) {
+    (*(SectionData *)context)[name] = value;
+  }
+
+  return 1;
+}
+
+// Simulator given to SimpleSSD
+class Proxy : public SimpleSSD::Simulator {
+ private:
+  Engine &engine() {
+    if (activeEngine == nullptr) {
+      SimpleSSD::panic("No active simulation context");
+    }
+
+    return *activeEngine;
+  }
+
+ public:
+  uint64_t getCurrentTick() override { return engine().getCurrentTick(); }
+
+  SimpleSSD::Event allocateEvent(SimpleSSD::EventFunction func) override {
+    return engine().allocateEvent(std::move(func));
+  }
+
+  void scheduleEvent(SimpleSSD::Event eid, uint64_t tick) override {
+    engine().scheduleEvent(eid, tick);
+  }
+
+  void descheduleEvent(SimpleSSD::Event eid) override {
+    engine().descheduleEvent(eid);
+  }
+
+  bool isScheduled(SimpleSSD::Event eid, uint64_t *pTick) override {
+    return engine().isScheduled(eid, pTick);
+  }
+
+  void deallocateEvent(SimpleSSD::Event eid) override {
+    engine().deallocateEvent(eid);
+  }
+};
+
+static Proxy proxy;
+
+Simulation::Simulation()
+    : pEngine(nullptr),
+      pInterface(nullptr),
+      pBIOEntry(nullptr),
+      ssdInitialized(false),
+      timeEvent(0) {}
+
+Simulation::~Simulation() {
+  if (pEngine == nullptr) {
+    return;
+  }
+
+  activate();
+
+  // Last context releases SimpleSSD
+  if (ssdInitialized && --refCount == 0) {
+    releaseSimpleSSDEngine();
+  }
+
+  delete pInterface;
+  delete pBIOEntry;
+
+  pEngine->deallocateEvent(timeEvent);
+
+  delete pEngine;
+
+  activeEngine = nullptr;
+}
+
+void Simulation::activate() {
+  activeEngine = pEngine;
+}
+
+bool Simulation::init(std::string ssdConfigPath, std::ostream *pDebugLog,
+                      BIL::LatencyLog *pLatencyLog) {
+  // Create event engine
+  pEngine = new Engine(
+      (EVENT_QUEUE)config.readUint(CONFIG_GLOBAL, GLOBAL_EVENT_QUEUE),
+      config.readBoolean(CONFIG_GLOBAL, GLOBAL_EVENT_PROFILE));
+  timeEvent = pEngine->allocateEvent([](uint64_t) {});
+
+  activate();
+
+  // Create worker processes of multi-device mode
+  // Workers initialize their own SimpleSSD, so this should be done before
+  // SimpleSSD is initialized in this process
+  if (config.readUint(CONFIG_GLOBAL, GLOBAL_DEVICE_COUNT) > 1) {
+    pInterface = new SIL::Parallel::Driver(*pEngine, config, ssdConfigPath,
+                                           pDebugLog);
+  }
+
+  // Initialize SimpleSSD
+  SectionData section;
+
+  if (ini_parse(ssdConfigPath.c_str(), sectionHandler, &section) < 0) {
+    SimpleSSD::panic("Failed to read SimpleSSD configuration file");
+  }
+
+  if (refCount == 0) {
+    ssdConfig =
+        initSimpleSSDEngine(&proxy, pDebugLog, pDebugLog, ssdConfigPath);
+    processSection = section;
+  }
+  else if (pInterface == nullptr && section != processSection) {
+    // Workers of multi-device mode have their own SimpleSSD
+    SimpleSSD::warn("[%s] section of %s differs from first simulation "
+                    "context. It is shared by all contexts in one process.",
+                    SECTION_PROCESS, ssdConfigPath.c_str());
+
+    return false;
+  }
+  else if (!ssdConfig.init(ssdConfigPath)) {
+    SimpleSSD::panic("Failed to read SimpleSSD configuration file");
+  }
+
+  refCount++;
+  ssdInitialized = true;
+
+  // Create Driver
+  if (pInterface == nullptr) {
+    switch (config.readUint(CONFIG_GLOBAL, GLOBAL_INTERFACE)) {
+      case INTERFACE_NONE:
+        pInterface = new SIL::None::Driver(*pEngine, ssdConfig);
+
+        break;
+      case INTERFACE_NVME:
+        pInterface = new SIL::NVMe::Driver(*pEngine, config, ssdConfig);
+
+        break;
+      default:
+        return false;
+    }
+  }
+
+  // Create Block I/O Layer
+  pBIOEntry = new BIL::BlockIOEntry(config, *pEngine, pInterface, pLatencyLog);
+
+  pInterface->initStats(statList);
+
+  return true;
+}
+
+uint64_t Simulation::advance(uint64_t tick) {
+  uint64_t next;
+
+  activate();
+
+  if (tick > pEngine->getCurrentTick()) {
+    pEngine->scheduleEvent(timeEvent, tick);
+  }
+
+  while (pEngine->getNextTick(next) && next <= tick) {
+    if (!pEngine->doNextBatch()) {
+      break;
+    }
+  }
+
+  return pEngine->getCurrentTick();
+}
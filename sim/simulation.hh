@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_SIMULATION__
+#define __SIM_SIMULATION__
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bil/entry.hh"
+#include "bil/interface.hh"
+#include "sim/cfg_reader.hh"
+#include "sim/engine.hh"
+#include "simplessd/util/simplessd.hh"
+
+// Simulation context - engine, driver and block I/O layer of one simulated
+// host and SSD
+//
+// SimpleSSD is initialized once per process and keeps one simulator pointer
+// in global variable. It is bound to a proxy which forwards to the engine of
+// active context, so contexts can be interleaved in one thread. Global
+// state of SimpleSSD (CPU model, logs) is shared by all contexts, so do not
+// run contexts on multiple threads concurrently. CPU model is configured by
+// first context only, and firmware work of all contexts runs on it (cpu.*
+// statistics cover all contexts). Context whose [cpu] section differs from
+// first one is rejected.
+class Simulation {
+ private:
+  ConfigReader config;
+  SimpleSSD::ConfigReader ssdConfig;
+
+  Engine *pEngine;
+  BIL::DriverInterface *pInterface;
+  BIL::BlockIOEntry *pBIOEntry;
+  std::vector<SimpleSSD::Stats> statList;
+
+  bool ssdInitialized;
+  SimpleSSD::Event timeEvent;  // Moves simulation time in advance()
+
+ public:
+  Simulation();
+  Simulation(const Simulation &) = delete;
+  ~Simulation();
+
+  // Make this context receive calls from SimpleSSD
+  // Every operation which may call SimpleSSD should be done while active
+  void activate();
+
+  // Returns false if interface in simulation configuration is invalid, or
+  // [cpu] section of SimpleSSD configuration differs from other context
+  bool init(std::string, std::ostream * = nullptr,
+            BIL::LatencyLog * = nullptr);
+
+  // Run simulation until given tick, returns current tick
+  uint64_t advance(uint64_t);
+
+  ConfigReader &getConfig() { return config; }
+  Engine &getEngine() { return *pEngine; }
+  BIL::DriverInterface &getInterface() { return *pInterface; }
+  BIL::BlockIOEntry &getBlockIO() { return *pBIOEntry; }
+  std::vector<SimpleSSD::Stats> &getStatList() { return statList; }
+};
+
+#endif
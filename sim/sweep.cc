@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/sweep.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <regex>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "simplessd/sim/trace.hh"
+#include "util/convert.hh"
+#include "util/pipe.hh"
+
+// Comma separated list of plain tokens - quoted strings and regular
+// expressions are never treated as list
+const std::regex regexList("[\\w.+-]+(\\s*,\\s*[\\w.+-]+)+",
+                           std::regex_constants::ECMAScript);
+
+static std::string trim(std::string str) {
+  const char *space = " \t\r\n";
+  auto begin = str.find_first_not_of(space);
+
+  if (begin == std::string::npos) {
+    return std::string();
+  }
+
+  return str.substr(begin, str.find_last_not_of(space) - begin + 1);
+}
+
+static bool makeDirectory(std::string &path) {
+#ifdef _MSC_VER
+  int ret = _mkdir(path.c_str());
+#else
+  int ret = mkdir(path.c_str(), 0755);
+#endif
+
+  return ret == 0 || errno == EEXIST;
+}
+
+static bool writeLines(std::string &path, std::vector<std::string> &lines) {
+  std::ofstream out(path);
+
+  if (!out.is_open()) {
+    return false;
+  }
+
+  for (auto &line : lines) {
+    out << line << std::endl;
+  }
+
+  return out.good();
+}
+
+bool Sweep::init(std::string simPath, std::string ssdPath) {
+  return parseFile(0, simPath) && parseFile(1, ssdPath);
+}
+
+bool Sweep::parseFile(uint32_t file, std::string path) {
+  std::ifstream in(path);
+  std::string line;
+  std::string section;
+
+  if (!in.is_open()) {
+    return false;
+  }
+
+  while (std::getline(in, line)) {
+    uint64_t idx = lineList[file].size();
+    std::string str = trim(line);
+
+    lineList[file].push_back(line);
+
+    if (str.length() == 0 || str[0] == '#' || str[0] == ';') {
+      continue;
+    }
+
+    if (str[0] == '[') {
+      section = str.substr(1, str.find(']') - 1);
+
+      continue;
+    }
+
+    auto pos = line.find('=');
+
+    if (pos == std::string::npos) {
+      continue;
+    }
+
+    std::string value = trim(line.substr(pos + 1));
+
+    if (!std::regex_match(value, regexList)) {
+      continue;
+    }
+
+    Parameter param;
+
+    param.file = file;
+    param.line = idx;
+    param.prefix = line.substr(0, pos + 1);
+    param.name = (file == 0 ? "" : "ssd.") + section + "." +
+                 trim(line.substr(0, pos));
+
+    expand(value, param.values);
+
+    paramList.push_back(std::move(param));
+  }
+
+  return true;
+}
+
+void Sweep::expand(std::string &value, std::vector<std::string> &list) {
+  std::vector<std::string> tokenList;
+  std::vector<uint64_t> number;
+  uint64_t begin = 0;
+  uint64_t end;
+  bool arithmetic = true;
+  bool geometric = true;
+  bool valid;
+
+  while (true) {
+    end = value.find(',', begin);
+    tokenList.push_back(trim(value.substr(begin, end - begin)));
+
+    if (end == std::string::npos) {
+      break;
+    }
+
+    begin = end + 1;
+  }
+
+  auto ellipsis = std::find(tokenList.begin(), tokenList.end(), "...");
+
+  if (ellipsis == tokenList.end()) {
+    list = std::move(tokenList);
+
+    return;
+  }
+
+  // a, b, [c, ...,] ..., z
+  if (ellipsis != tokenList.end() - 2 || tokenList.size() < 4) {
+    SimpleSSD::panic("Invalid sweep range: %s", value.c_str());
+  }
+
+  tokenList.erase(ellipsis);
+
+  for (auto &token : tokenList) {
+    number.push_back(convertInteger(token.c_str(), &valid));
+
+    if (!valid) {
+      SimpleSSD::panic("Sweep range requires integer values: %s",
+                       value.c_str());
+    }
+  }
+
+  end = number.back();
+  number.pop_back();
+
+  // Two leading values always define arithmetic progression
+  uint64_t step = number[1] - number[0];
+  uint64_t ratio = number[0] > 0 ? number[1] / number[0] : 0;
+
+  for (uint64_t i = 1; i < number.size(); i++) {
+    if (number[i] <= number[i - 1]) {
+      SimpleSSD::panic("Sweep range should be increasing: %s", value.c_str());
+    }
+
+    if (number[i] - number[i - 1] != step) {
+      arithmetic = false;
+    }
+    if (number[i - 1] == 0 || number[i] != number[i - 1] * ratio) {
+      geometric = false;
+    }
+  }
+
+  if (!arithmetic && !geometric) {
+    SimpleSSD::panic("Cannot infer progression of sweep range: %s",
+                     value.c_str());
+  }
+
+  for (auto n : number) {
+    list.push_back(std::to_string(n));
+  }
+
+  // Continue progression up to last value
+  uint64_t next = number.back();
+
+  while (next < end) {
+    if (arithmetic) {
+      if (end - next < step) {
+        break;
+      }
+
+      next += step;
+    }
+    else {
+      if (next > end / ratio) {
+        break;
+      }
+
+      next *= ratio;
+    }
+
+    list.push_back(std::to_string(next));
+  }
+}
+
+uint64_t Sweep::getPointCount() {
+  uint64_t count = 1;
+
+  for (auto &param : paramList) {
+    count *= param.values.size();
+  }
+
+  return count;
+}
+
+uint64_t Sweep::getValueIndex(uint64_t point, uint64_t idx) {
+  // Last parameter changes fastest
+  for (uint64_t i = paramList.size() - 1; i > idx; i--) {
+    point /= paramList[i].values.size();
+  }
+
+  return point % paramList[idx].values.size();
+}
+
+bool Sweep::writePoint(uint64_t point, std::string dir, std::string &simPath,
+                       std::string &ssdPath) {
+  std::vector<std::string> lines[2] = {lineList[0], lineList[1]};
+
+  for (uint64_t i = 0; i < paramList.size(); i++) {
+    auto &param = paramList[i];
+
+    lines[param.file][param.line] =
+        param.prefix + " " + param.values[getValueIndex(point, i)];
+  }
+
+  simPath = dir + "/simulation.cfg";
+  ssdPath = dir + "/simplessd.cfg";
+
+  return makeDirectory(dir) && writeLines(simPath, lines[0]) &&
+         writeLines(ssdPath, lines[1]);
+}
+
+void Sweep::writeTable(std::string dir, std::vector<SweepResult> &resultList) {
+  std::ofstream csv(dir + "/sweep.csv");
+  std::ofstream json(dir + "/sweep.json");
+
+  if (!csv.is_open() || !json.is_open()) {
+    SimpleSSD::panic("Failed to open sweep result file");
+  }
+
+  csv << "point";
+
+  for (auto &param : paramList) {
+    csv << "," << param.name;
+  }
+
+  csv << ",status,time_ps,io_count,io_bytes,iops,bandwidth,lat_min,lat_avg,"
+         "lat_p50,lat_p90,lat_p99,lat_p999,lat_max"
+      << std::endl;
+  json << "[" << std::endl;
+
+  for (uint64_t point = 0; point < resultList.size(); point++) {
+    auto &result = resultList[point];
+    auto &latency = result.latency;
+    double sec = result.duration / 1000000000000.;
+    double iops = sec > 0. ? latency.getCount() / sec : 0.;
+    double bandwidth = sec > 0. ? result.bytes / sec : 0.;
+
+    csv << point;
+    json << "  {\"point\": " << point << ", \"params\": {";
+
+    for (uint64_t i = 0; i < paramList.size(); i++) {
+      auto &value = paramList[i].values[getValueIndex(point, i)];
+
+      csv << "," << value;
+      json << (i == 0 ? "" : ", ") << "\"" << paramList[i].name << "\": \""
+           << value << "\"";
+    }
+
+    json << "}, \"status\": \"" << (result.valid ? "ok" : "failed") << "\"";
+
+    if (!result.valid) {
+      csv << ",failed,,,,,,,,,,,," << std::endl;
+      json << "}" << (point + 1 < resultList.size() ? "," : "") << std::endl;
+
+      continue;
+    }
+
+    csv << ",ok," << result.duration << "," << latency.getCount() << ","
+        << result.bytes << "," << std::to_string(iops) << ","
+        << std::to_string(bandwidth) << "," << latency.getMin() << ","
+        << std::to_string(latency.getMean()) << ","
+        << latency.getPercentile(50.) << "," << latency.getPercentile(90.)
+        << "," << latency.getPercentile(99.) << ","
+        << latency.getPercentile(99.9) << "," << latency.getMax()
+        << std::endl;
+    json << ", \"time_ps\": " << result.duration
+         << ", \"io_count\": " << latency.getCount()
+         << ", \"io_bytes\": " << result.bytes
+         << ", \"iops\": " << std::to_string(iops)
+         << ", \"bandwidth\": " << std::to_string(bandwidth)
+         << ", \"latency_ps\": {\"min\": " << latency.getMin()
+         << ", \"avg\": " << std::to_string(latency.getMean())
+         << ", \"p50\": " << latency.getPercentile(50.)
+         << ", \"p90\": " << latency.getPercentile(90.)
+         << ", \"p99\": " << latency.getPercentile(99.)
+         << ", \"p999\": " << latency.getPercentile(99.9)
+         << ", \"max\": " << latency.getMax() << "}}"
+         << (point + 1 < resultList.size() ? "," : "") << std::endl;
+  }
+
+  json << "]" << std::endl;
+}
+
+void writeSweepResult(int fd, SweepResult &result) {
+  std::vector<uint64_t> data;
+  uint64_t length;
+
+  writeAll(fd, &result.duration, sizeof(uint64_t));
+  writeAll(fd, &result.bytes, sizeof(uint64_t));
+
+  result.latency.serialize(data);
+  length = data.size();
+
+  writeAll(fd, &length, sizeof(uint64_t));
+  writeAll(fd, data.data(), length * sizeof(uint64_t));
+}
+
+bool readSweepResult(int fd, SweepResult &result) {
+  std::vector<uint64_t> data;
+  uint64_t length;
+
+  // Point process exited without result
+  if (!tryReadAll(fd, &result.duration, sizeof(uint64_t))) {
+    return false;
+  }
+
+  readAll(fd, &result.bytes, sizeof(uint64_t));
+  readAll(fd, &length, sizeof(uint64_t));
+
+  data.resize(length);
+  readAll(fd, data.data(), length * sizeof(uint64_t));
+
+  result.latency.deserialize(data);
+  result.valid = true;
+
+  return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_SWEEP__
+#define __SIM_SWEEP__
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "util/histogram.hh"
+
+// Summary of one sweep point
+typedef struct _SweepResult {
+  bool valid;         // False when simulation of point failed
+  uint64_t duration;  // Simulated time in ps
+  uint64_t bytes;
+  Histogram latency;
+
+  _SweepResult()
+      : valid(false), duration(0), bytes(0), latency(LATENCY_PRECISION) {}
+} SweepResult;
+
+// Parameter sweep over simulation and SimpleSSD configuration files
+// Value written as comma separated list makes the key a sweep parameter:
+//   QueueDepth = 1,2,4,...,256  (progression inferred from leading values)
+//   BlockSize = 4K,8K,16K
+// Simulation runs at every point of cross-product of all parameters.
+class Sweep {
+ private:
+  typedef struct _Parameter {
+    uint32_t file;  // 0: simulation, 1: SimpleSSD configuration
+    uint64_t line;
+    std::string prefix;  // Line up to '='
+    std::string name;
+    std::vector<std::string> values;
+  } Parameter;
+
+  std::vector<std::string> lineList[2];
+  std::vector<Parameter> paramList;
+
+  bool parseFile(uint32_t, std::string);
+  void expand(std::string &, std::vector<std::string> &);
+  uint64_t getValueIndex(uint64_t, uint64_t);
+
+ public:
+  bool init(std::string, std::string);
+
+  uint64_t getParameterCount() { return paramList.size(); }
+  uint64_t getPointCount();
+
+  // Write configuration files of point to given directory
+  bool writePoint(uint64_t, std::string, std::string &, std::string &);
+
+  // Write sweep.csv and sweep.json to given directory
+  void writeTable(std::string, std::vector<SweepResult> &);
+};
+
+// Point process sends its result to sweep process through pipe
+void writeSweepResult(int, SweepResult &);
+bool readSweepResult(int, SweepResult &);  // False when point failed
+
+#endif
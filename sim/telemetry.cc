@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/telemetry.hh"
+
+#include <cstring>
+
+Telemetry::Telemetry() : sequence(0) {
+  for (int i = 0; i < FIELD_NUM; i++) {
+    published[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Telemetry::publish() {
+  uint64_t seq = sequence.load(std::memory_order_relaxed);
+  uint64_t progress;
+
+  memcpy(&progress, &local.progress, sizeof(uint64_t));
+
+  // Odd sequence number means update in progress
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  published[FIELD_TICK].store(local.tick, std::memory_order_relaxed);
+  published[FIELD_EVENT_HANDLED].store(local.eventHandled,
+                                       std::memory_order_relaxed);
+  published[FIELD_IO_COUNT].store(local.ioCount, std::memory_order_relaxed);
+  published[FIELD_IO_BYTES].store(local.ioBytes, std::memory_order_relaxed);
+  published[FIELD_IO_LATENCY].store(local.ioLatency,
+                                    std::memory_order_relaxed);
+  published[FIELD_PROGRESS].store(progress, std::memory_order_relaxed);
+
+  sequence.store(seq + 2, std::memory_order_release);
+}
+
+void Telemetry::read(TelemetryData &data) {
+  uint64_t begin;
+  uint64_t end;
+  uint64_t progress;
+
+  do {
+    begin = sequence.load(std::memory_order_acquire);
+
+    data.tick = published[FIELD_TICK].load(std::memory_order_relaxed);
+    data.eventHandled =
+        published[FIELD_EVENT_HANDLED].load(std::memory_order_relaxed);
+    data.ioCount = published[FIELD_IO_COUNT].load(std::memory_order_relaxed);
+    data.ioBytes = published[FIELD_IO_BYTES].load(std::memory_order_relaxed);
+    data.ioLatency =
+        published[FIELD_IO_LATENCY].load(std::memory_order_relaxed);
+    progress = published[FIELD_PROGRESS].load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    end = sequence.load(std::memory_order_relaxed);
+  } while ((begin & 1) || begin != end);
+
+  memcpy(&data.progress, &progress, sizeof(uint64_t));
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_TELEMETRY__
+#define __SIM_TELEMETRY__
+
+#include <atomic>
+#include <cinttypes>
+
+typedef struct _TelemetryData {
+  uint64_t tick;          // Simulation tick
+  uint64_t eventHandled;  // Number of handled events, not reset by stats
+  uint64_t ioCount;       // Number of completed I/O
+  uint64_t ioBytes;       // Bytes of completed I/O
+  uint64_t ioLatency;     // Sum of latency of completed I/O
+  double progress;        // Progress of I/O generator (0.0 ~ 1.0)
+
+  _TelemetryData()
+      : tick(0),
+        eventHandled(0),
+        ioCount(0),
+        ioBytes(0),
+        ioLatency(0),
+        progress(0.0) {}
+} TelemetryData;
+
+// Simulation status shared with progress thread
+// Simulation thread (only writer) updates local copy without any
+// synchronization, and publishes it with sequence lock. Other threads read
+// consistent snapshot without blocking the simulation thread.
+class Telemetry {
+ private:
+  enum {
+    FIELD_TICK,
+    FIELD_EVENT_HANDLED,
+    FIELD_IO_COUNT,
+    FIELD_IO_BYTES,
+    FIELD_IO_LATENCY,
+    FIELD_PROGRESS,
+    FIELD_NUM,
+  };
+
+  TelemetryData local;
+
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> published[FIELD_NUM];
+
+ public:
+  Telemetry();
+
+  // Simulation thread only
+  TelemetryData &data() { return local; }
+  void publish();
+
+  // Any thread
+  void read(TelemetryData &);
+};
+
+#endif
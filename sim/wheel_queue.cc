@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim/wheel_queue.hh"
+
+#include <cstring>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define BUCKET_OVERFLOW (WHEEL_LEVELS * WHEEL_SLOTS)
+#define BUCKET_READY (BUCKET_OVERFLOW + 1)
+#define BUCKET_NONE (BUCKET_OVERFLOW + 2)
+#define NO_EVENT std::numeric_limits<uint64_t>::max()
+
+static inline uint32_t lowestBit(uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long idx;
+
+  _BitScanForward64(&idx, value);
+
+  return (uint32_t)idx;
+#else
+  return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+WheelQueue::WheelQueue() : cursor(0), count(0) {
+  Bucket empty;
+
+  empty.head = NO_EVENT;
+  empty.tail = NO_EVENT;
+
+  buckets.resize(BUCKET_OVERFLOW + 1, empty);
+  memset(bitmap, 0, sizeof(bitmap));
+}
+
+WheelQueue::~WheelQueue() {}
+
+void WheelQueue::link(uint32_t idx, SimpleSSD::Event eid) {
+  Bucket &bucket = buckets[idx];
+  Node &node = nodes[eid];
+
+  node.bucket = idx;
+  node.prev = bucket.tail;
+  node.next = NO_EVENT;
+
+  if (bucket.tail == NO_EVENT) {
+    bucket.head = eid;
+  }
+  else {
+    nodes[bucket.tail].next = eid;
+  }
+
+  bucket.tail = eid;
+
+  if (idx < BUCKET_OVERFLOW) {
+    bitmap[idx / WHEEL_SLOTS][(idx % WHEEL_SLOTS) / 64] |= 1ull << (idx % 64);
+  }
+}
+
+void WheelQueue::unlink(SimpleSSD::Event eid) {
+  Node &node = nodes[eid];
+  uint32_t idx = node.bucket;
+  Bucket &bucket = buckets[idx];
+
+  if (node.prev == NO_EVENT) {
+    bucket.head = node.next;
+  }
+  else {
+    nodes[node.prev].next = node.next;
+  }
+
+  if (node.next == NO_EVENT) {
+    bucket.tail = node.prev;
+  }
+  else {
+    nodes[node.next].prev = node.prev;
+  }
+
+  if (bucket.head == NO_EVENT && idx < BUCKET_OVERFLOW) {
+    bitmap[idx / WHEEL_SLOTS][(idx % WHEEL_SLOTS) / 64] &=
+        ~(1ull << (idx % 64));
+  }
+
+  node.bucket = BUCKET_NONE;
+}
+
+void WheelQueue::place(SimpleSSD::Event eid) {
+  Node &node = nodes[eid];
+  uint64_t unit = node.tick >> WHEEL_RESOLUTION_BITS;
+
+  if (unit <= cursor) {
+    // Current slot - needs exact ordering
+    node.bucket = BUCKET_READY;
+    ready.insert(eid, node.tick);
+
+    return;
+  }
+
+  // Find lowest level which shares upper digits with cursor
+  for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+    uint32_t shift = WHEEL_SLOT_BITS * (level + 1);
+
+    if ((unit >> shift) == (cursor >> shift)) {
+      link(level * WHEEL_SLOTS +
+               (uint32_t)((unit >> (shift - WHEEL_SLOT_BITS)) &
+                          (WHEEL_SLOTS - 1)),
+           eid);
+
+      return;
+    }
+  }
+
+  link(BUCKET_OVERFLOW, eid);
+}
+
+void WheelQueue::cascade(uint32_t idx) {
+  Bucket &bucket = buckets[idx];
+  SimpleSSD::Event eid = bucket.head;
+
+  // Detach whole list first, as events may be placed in same bucket again
+  bucket.head = NO_EVENT;
+  bucket.tail = NO_EVENT;
+
+  if (idx < BUCKET_OVERFLOW) {
+    bitmap[idx / WHEEL_SLOTS][(idx % WHEEL_SLOTS) / 64] &=
+        ~(1ull << (idx % 64));
+  }
+
+  // Keep order of list, to keep insertion order of events at same tick
+  while (eid != NO_EVENT) {
+    SimpleSSD::Event next = nodes[eid].next;
+
+    place(eid);
+
+    eid = next;
+  }
+}
+
+bool WheelQueue::findSlot(uint32_t level, uint32_t from, uint32_t &slot) {
+  for (uint32_t word = from / 64; word < WHEEL_SLOTS / 64; word++) {
+    uint64_t bits = bitmap[level][word];
+
+    if (word == from / 64) {
+      bits &= ~0ull << (from % 64);
+    }
+
+    if (bits) {
+      slot = word * 64 + lowestBit(bits);
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool WheelQueue::advance() {
+  while (ready.empty()) {
+    bool found = false;
+
+    if (count == 0) {
+      return false;
+    }
+
+    // Slots before cursor are always empty, so find next non-empty slot from
+    // lowest level and move cursor to beginning of that slot
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+      uint32_t shift = WHEEL_SLOT_BITS * level;
+      uint32_t digit = (uint32_t)((cursor >> shift) & (WHEEL_SLOTS - 1));
+      uint32_t slot;
+
+      if (findSlot(level, digit + 1, slot)) {
+        shift += WHEEL_SLOT_BITS;
+
+        cursor = ((cursor >> shift) << shift) |
+                 ((uint64_t)slot << (shift - WHEEL_SLOT_BITS));
+
+        cascade(level * WHEEL_SLOTS + slot);
+        found = true;
+
+        break;
+      }
+    }
+
+    if (!found) {
+      // Wheel is empty. Move cursor to earliest event in overflow bucket
+      SimpleSSD::Event eid = buckets[BUCKET_OVERFLOW].head;
+      uint64_t min = std::numeric_limits<uint64_t>::max();
+
+      if (eid == NO_EVENT) {
+        return false;
+      }
+
+      for (; eid != NO_EVENT; eid = nodes[eid].next) {
+        uint64_t unit = nodes[eid].tick >> WHEEL_RESOLUTION_BITS;
+
+        if (min > unit) {
+          min = unit;
+        }
+      }
+
+      cursor = min;
+
+      cascade(BUCKET_OVERFLOW);
+    }
+  }
+
+  return true;
+}
+
+bool WheelQueue::insert(SimpleSSD::Event eid, uint64_t tick,
+                        uint64_t *pOldTick) {
+  bool found = false;
+
+  if (eid >= nodes.size()) {
+    Node empty;
+
+    empty.tick = 0;
+    empty.bucket = BUCKET_NONE;
+    empty.prev = NO_EVENT;
+    empty.next = NO_EVENT;
+
+    nodes.resize(eid + 1, empty);
+  }
+
+  Node &node = nodes[eid];
+
+  if (node.bucket != BUCKET_NONE) {
+    if (pOldTick) {
+      *pOldTick = node.tick;
+    }
+
+    if (node.tick == tick) {
+      // Rescheduling to same tick. Ignore.
+      return false;
+    }
+
+    remove(eid);
+    found = true;
+  }
+
+  node.tick = tick;
+
+  place(eid);
+  count++;
+
+  return found;
+}
+
+bool WheelQueue::remove(SimpleSSD::Event eid) {
+  if (eid >= nodes.size() || nodes[eid].bucket == BUCKET_NONE) {
+    return false;
+  }
+
+  if (nodes[eid].bucket == BUCKET_READY) {
+    ready.remove(eid);
+    nodes[eid].bucket = BUCKET_NONE;
+  }
+  else {
+    unlink(eid);
+  }
+
+  count--;
+
+  return true;
+}
+
+bool WheelQueue::find(SimpleSSD::Event eid, uint64_t *pTick) {
+  if (eid >= nodes.size() || nodes[eid].bucket == BUCKET_NONE) {
+    return false;
+  }
+
+  if (pTick) {
+    *pTick = nodes[eid].tick;
+  }
+
+  return true;
+}
+
+bool WheelQueue::empty() {
+  return count == 0;
+}
+
+uint64_t WheelQueue::size() {
+  return count;
+}
+
+bool WheelQueue::front(SimpleSSD::Event &eid, uint64_t &tick) {
+  if (!advance()) {
+    return false;
+  }
+
+  return ready.front(eid, tick);
+}
+
+void WheelQueue::pop() {
+  SimpleSSD::Event eid;
+  uint64_t tick;
+
+  if (advance() && ready.front(eid, tick)) {
+    ready.pop();
+    nodes[eid].bucket = BUCKET_NONE;
+    count--;
+  }
+}
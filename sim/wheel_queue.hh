@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __SIM_WHEEL_QUEUE__
+#define __SIM_WHEEL_QUEUE__
+
+#include <cinttypes>
+#include <vector>
+
+#include "sim/event_queue.hh"
+#include "sim/heap_queue.hh"
+
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_RESOLUTION_BITS 10  // 1 slot of level 0 = 1024ps
+
+// Hierarchical timing wheel (calendar queue) of scheduled events
+// Level 0 slot covers 2^10 ps, and each upper level covers 256 slots of lower
+// level (~262ns, ~67us, ~17ms, ~4.4s in total per level). Events beyond the
+// last level are kept in overflow bucket. Events in current slot of level 0
+// are moved to small heap to keep exact tick and insertion order.
+class WheelQueue : public EventQueue {
+ private:
+  typedef struct _Node {
+    uint64_t tick;
+    uint32_t bucket;
+    SimpleSSD::Event prev;
+    SimpleSSD::Event next;
+  } Node;
+
+  typedef struct _Bucket {
+    SimpleSSD::Event head;
+    SimpleSSD::Event tail;
+  } Bucket;
+
+  std::vector<Node> nodes;  // Indexed by event ID
+  std::vector<Bucket> buckets;
+  uint64_t bitmap[WHEEL_LEVELS][WHEEL_SLOTS / 64];
+  HeapQueue ready;
+
+  uint64_t cursor;  // Current time in unit of level 0 slot
+  uint64_t count;
+
+  void link(uint32_t, SimpleSSD::Event);
+  void unlink(SimpleSSD::Event);
+  void place(SimpleSSD::Event);
+  void cascade(uint32_t);
+  bool findSlot(uint32_t, uint32_t, uint32_t &);
+  bool advance();
+
+ public:
+  WheelQueue();
+  ~WheelQueue();
+
+  bool insert(SimpleSSD::Event, uint64_t, uint64_t * = nullptr) override;
+  bool remove(SimpleSSD::Event) override;
+  bool find(SimpleSSD::Event, uint64_t * = nullptr) override;
+
+  bool empty() override;
+  uint64_t size() override;
+  bool front(SimpleSSD::Event &, uint64_t &) override;
+  void pop() override;
+};
+
+#endif
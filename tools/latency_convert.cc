@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "bil/latency_log.hh"
+
+// Converts binary latency log (LatencyLogFormat = 1) to CSV
+
+const size_t BUFFER_SIZE = 1048576;
+
+static bool flush(std::vector<char> &buffer, FILE *out) {
+  bool ret = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+
+  buffer.clear();
+
+  return ret;
+}
+
+int main(int argc, char *argv[]) {
+  BIL::LatencyRecord record;
+  std::vector<char> buffer;
+  char magic[sizeof(BIL::LOG_MAGIC)];
+  char line[BIL::LOG_CSV_LENGTH];
+  uint64_t total = 0;
+  bool failed = false;
+
+  if (argc != 3) {
+    fprintf(stderr, "Usage: latency-convert <Binary latency log> <CSV "
+                    "output>\n");
+
+    return 1;
+  }
+
+  FILE *in = fopen(argv[1], "rb");
+
+  if (in == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", argv[1]);
+
+    return 2;
+  }
+
+  if (fread(magic, sizeof(magic), 1, in) != 1 ||
+      memcmp(magic, BIL::LOG_MAGIC, sizeof(magic)) != 0) {
+    fprintf(stderr, "%s is not a binary latency log\n", argv[1]);
+    fclose(in);
+
+    return 2;
+  }
+
+  FILE *out = fopen(argv[2], "wb");
+
+  if (out == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", argv[2]);
+    fclose(in);
+
+    return 2;
+  }
+
+  buffer.reserve(BUFFER_SIZE);
+
+  // Breakdown entries follow fixed part of record (LatencyBreakdown = 1)
+  while (fread(&record, BIL::LOG_RECORD_BASE, 1, in) == 1) {
+    if (record.stages > BIL::BREAKDOWN_NUM ||
+        fread(record.stage, sizeof(uint64_t), record.stages, in) !=
+            record.stages) {
+      fprintf(stderr, "%s has truncated or invalid record\n", argv[1]);
+      fclose(in);
+      fclose(out);
+
+      return 2;
+    }
+
+    uint32_t length = BIL::LatencyLog::formatCSV(line, record);
+
+    buffer.insert(buffer.end(), line, line + length);
+    total++;
+
+    if (buffer.size() >= BUFFER_SIZE) {
+      failed |= !flush(buffer, out);
+    }
+  }
+
+  failed |= !flush(buffer, out);
+
+  fclose(in);
+  fclose(out);
+
+  if (failed) {
+    fprintf(stderr, "Failed to write %s\n", argv[2]);
+
+    return 3;
+  }
+
+  printf("Converted %" PRIu64 " records\n", total);
+
+  return 0;
+}
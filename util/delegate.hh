@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __UTIL_DELEGATE__
+#define __UTIL_DELEGATE__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only callable wrapper with fixed inline storage
+// Unlike std::function, this never allocates memory. Callable larger than
+// storage is rejected at compile time.
+template <typename T, size_t N = 3 * sizeof(void *)>
+class Delegate;
+
+template <typename R, typename... Args, size_t N>
+class Delegate<R(Args...), N> {
+ private:
+  typedef R (*Invoker)(void *, Args...);
+  typedef void (*Manager)(void *, void *);  // Move to 2nd or destroy if null
+
+  typename std::aligned_storage<N>::type storage;
+  Invoker invoker;
+  Manager manager;
+
+  template <typename F>
+  static R invoke(void *p, Args... args) {
+    return (*(F *)p)(std::forward<Args>(args)...);
+  }
+
+  template <typename F>
+  static void manage(void *src, void *dst) {
+    if (dst) {
+      new (dst) F(std::move(*(F *)src));
+    }
+
+    ((F *)src)->~F();
+  }
+
+  void reset() {
+    if (manager) {
+      manager(&storage, nullptr);
+    }
+
+    invoker = nullptr;
+    manager = nullptr;
+  }
+
+  void moveFrom(Delegate &rhs) {
+    if (rhs.manager) {
+      rhs.manager(&rhs.storage, &storage);
+    }
+
+    invoker = rhs.invoker;
+    manager = rhs.manager;
+    rhs.invoker = nullptr;
+    rhs.manager = nullptr;
+  }
+
+ public:
+  Delegate() : invoker(nullptr), manager(nullptr) {}
+  Delegate(std::nullptr_t) : invoker(nullptr), manager(nullptr) {}
+
+  template <typename F, typename = typename std::enable_if<!std::is_same<
+                            typename std::decay<F>::type, Delegate>::value>::type>
+  Delegate(F &&f) {
+    typedef typename std::decay<F>::type Func;
+
+    static_assert(sizeof(Func) <= N, "Callable too large for Delegate");
+    static_assert(alignof(Func) <= alignof(decltype(storage)),
+                  "Callable alignment too large for Delegate");
+
+    new (&storage) Func(std::forward<F>(f));
+
+    invoker = &invoke<Func>;
+    manager = &manage<Func>;
+  }
+
+  Delegate(Delegate &&rhs) { moveFrom(rhs); }
+  Delegate(const Delegate &) = delete;
+
+  ~Delegate() { reset(); }
+
+  Delegate &operator=(Delegate &&rhs) {
+    if (this != &rhs) {
+      reset();
+      moveFrom(rhs);
+    }
+
+    return *this;
+  }
+
+  Delegate &operator=(std::nullptr_t) {
+    reset();
+
+    return *this;
+  }
+
+  Delegate &operator=(const Delegate &) = delete;
+
+  explicit operator bool() const { return invoker != nullptr; }
+
+  R operator()(Args... args) {
+    return invoker(&storage, std::forward<Args>(args)...);
+  }
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/histogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline uint32_t highestBit(uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long idx;
+
+  _BitScanReverse64(&idx, value);
+
+  return (uint32_t)idx;
+#else
+  return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+Histogram::Histogram(uint32_t p) : precision(p) {
+  if (precision > 16) {
+    precision = 16;
+  }
+
+  // Values smaller than 2^precision have their own bucket, and each of other
+  // (64 - precision) power-of-two ranges has 2^precision buckets
+  bucket.resize((uint64_t)(65 - precision) << precision);
+
+  reset();
+}
+
+uint32_t Histogram::getIndex(uint64_t value) {
+  if (value < (1ull << precision)) {
+    return (uint32_t)value;
+  }
+
+  uint32_t shift = highestBit(value) - precision;
+
+  return ((shift + 1) << precision) +
+         (uint32_t)((value >> shift) - (1ull << precision));
+}
+
+uint64_t Histogram::getLowerBound(uint32_t idx) {
+  if (idx < (1u << precision)) {
+    return idx;
+  }
+
+  uint32_t shift = (idx >> precision) - 1;
+  uint64_t mantissa = (idx & ((1u << precision) - 1)) + (1ull << precision);
+
+  return mantissa << shift;
+}
+
+uint64_t Histogram::getUpperBound(uint32_t idx) {
+  if (idx < (1u << precision)) {
+    return idx;
+  }
+
+  uint32_t shift = (idx >> precision) - 1;
+
+  return getLowerBound(idx) + ((1ull << shift) - 1);
+}
+
+void Histogram::add(uint64_t value, uint64_t n) {
+  bucket[getIndex(value)] += n;
+
+  count += n;
+  sum += (double)value * n;
+
+  if (minValue > value) {
+    minValue = value;
+  }
+  if (maxValue < value) {
+    maxValue = value;
+  }
+}
+
+void Histogram::merge(Histogram &rhs) {
+  if (precision != rhs.precision) {
+    // Re-bucket with lower bound of each source bucket
+    for (uint32_t i = 0; i < rhs.bucket.size(); i++) {
+      if (rhs.bucket[i] > 0) {
+        bucket[getIndex(rhs.getLowerBound(i))] += rhs.bucket[i];
+      }
+    }
+  }
+  else {
+    for (uint32_t i = 0; i < bucket.size(); i++) {
+      bucket[i] += rhs.bucket[i];
+    }
+  }
+
+  count += rhs.count;
+  sum += rhs.sum;
+
+  if (rhs.count > 0) {
+    if (minValue > rhs.minValue) {
+      minValue = rhs.minValue;
+    }
+    if (maxValue < rhs.maxValue) {
+      maxValue = rhs.maxValue;
+    }
+  }
+}
+
+void Histogram::reset() {
+  std::fill(bucket.begin(), bucket.end(), 0);
+
+  count = 0;
+  minValue = std::numeric_limits<uint64_t>::max();
+  maxValue = 0;
+  sum = 0.;
+}
+
+uint64_t Histogram::getPercentile(double percentile) {
+  uint64_t target;
+  uint64_t acc = 0;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  if (percentile >= 100.) {
+    return maxValue;
+  }
+
+  // Nearest rank
+  target = (uint64_t)ceil(percentile / 100. * count);
+
+  if (target == 0) {
+    target = 1;
+  }
+
+  for (uint32_t i = 0; i < bucket.size(); i++) {
+    acc += bucket[i];
+
+    if (acc >= target) {
+      uint64_t upper = getUpperBound(i);
+
+      return upper < maxValue ? upper : maxValue;
+    }
+  }
+
+  return maxValue;
+}
+
+void Histogram::print(std::ostream &out, const char *unit) {
+  for (uint32_t i = 0; i < bucket.size(); i++) {
+    if (bucket[i] == 0) {
+      continue;
+    }
+
+    out << "  [" << getLowerBound(i) << ", " << getUpperBound(i) << "]" << unit
+        << ": " << bucket[i] << " ("
+        << std::to_string(bucket[i] * 100. / count) << "%)" << std::endl;
+  }
+}
+
+void Histogram::serialize(std::vector<uint64_t> &data) {
+  uint64_t bits;
+
+  memcpy(&bits, &sum, sizeof(bits));
+
+  data.clear();
+  data.push_back(precision);
+  data.push_back(count);
+  data.push_back(minValue);
+  data.push_back(maxValue);
+  data.push_back(bits);
+  data.insert(data.end(), bucket.begin(), bucket.end());
+}
+
+void Histogram::deserialize(std::vector<uint64_t> &data) {
+  // Ignore malformed data
+  if (data.size() < 5 || data[0] > 16 ||
+      data.size() != 5 + ((uint64_t)(65 - data[0]) << data[0])) {
+    return;
+  }
+
+  precision = (uint32_t)data[0];
+  count = data[1];
+  minValue = data[2];
+  maxValue = data[3];
+  memcpy(&sum, &data[4], sizeof(sum));
+  bucket.assign(data.begin() + 5, data.end());
+}
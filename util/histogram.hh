@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __UTIL_HISTOGRAM__
+#define __UTIL_HISTOGRAM__
+
+#include <cinttypes>
+#include <iostream>
+#include <vector>
+
+// Precision of I/O latency histograms (3% error)
+const uint32_t LATENCY_PRECISION = 5;
+
+// Log-linear histogram
+// Each power-of-two range is divided into 2^precision linear sub-buckets, so
+// relative error of recorded value is bounded by 2^-precision.
+class Histogram {
+ private:
+  uint32_t precision;
+  std::vector<uint64_t> bucket;
+
+  uint64_t count;
+  uint64_t minValue;
+  uint64_t maxValue;
+  double sum;
+
+  uint32_t getIndex(uint64_t);
+  uint64_t getLowerBound(uint32_t);
+  uint64_t getUpperBound(uint32_t);
+
+ public:
+  Histogram(uint32_t = 3);
+
+  void add(uint64_t, uint64_t = 1);
+  void merge(Histogram &);
+  void reset();
+
+  uint64_t getCount() { return count; }
+  uint64_t getMin() { return count ? minValue : 0; }
+  uint64_t getMax() { return maxValue; }
+  double getMean() { return count ? sum / count : 0.; }
+
+  // Percentile in [0, 100]
+  // Returns upper bound of bucket (clamped to maximum value)
+  uint64_t getPercentile(double);
+
+  // Print non-empty buckets as "[lower, upper]: count (ratio)"
+  void print(std::ostream &, const char * = "");
+
+  // Flat representation to transfer histogram between processes
+  void serialize(std::vector<uint64_t> &);
+  void deserialize(std::vector<uint64_t> &);
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/mapped_file.hh"
+
+#include <unordered_map>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct _Mapping {
+  const char *data;
+  uint64_t size;
+} Mapping;
+
+static std::unordered_map<std::string, Mapping> mappingList;
+
+bool mapFile(std::string path) {
+#ifdef _MSC_VER
+  (void)path;
+
+  return false;
+#else
+  struct stat info;
+  Mapping mapping;
+
+  if (mappingList.count(path) > 0) {
+    return true;
+  }
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    return false;
+  }
+
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+
+    return false;
+  }
+
+  mapping.size = (uint64_t)info.st_size;
+  mapping.data = (const char *)mmap(nullptr, mapping.size, PROT_READ,
+                                    MAP_SHARED, fd, 0);
+
+  // Mapping is valid after closing file
+  close(fd);
+
+  if (mapping.data == MAP_FAILED) {
+    return false;
+  }
+
+  mappingList.emplace(path, mapping);
+
+  return true;
+#endif
+}
+
+bool findMappedFile(std::string path, const char *&data, uint64_t &size) {
+  auto iter = mappingList.find(path);
+
+  if (iter == mappingList.end()) {
+    return false;
+  }
+
+  data = iter->second.data;
+  size = iter->second.size;
+
+  return true;
+}
+
+void MemoryBuffer::open(const char *data, uint64_t size) {
+  // Buffer is never written through get area
+  char *begin = const_cast<char *>(data);
+
+  setg(begin, begin, begin + size);
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekoff(off_type off,
+                                             std::ios_base::seekdir dir,
+                                             std::ios_base::openmode) {
+  char *pos;
+
+  switch (dir) {
+    case std::ios_base::beg:
+      pos = eback() + off;
+      break;
+    case std::ios_base::cur:
+      pos = gptr() + off;
+      break;
+    default:
+      pos = egptr() + off;
+      break;
+  }
+
+  if (pos < eback() || pos > egptr()) {
+    return pos_type(off_type(-1));
+  }
+
+  setg(eback(), pos, egptr());
+
+  return pos_type(pos - eback());
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekpos(pos_type pos,
+                                             std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
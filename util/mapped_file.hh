@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __UTIL_MAPPED_FILE__
+#define __UTIL_MAPPED_FILE__
+
+#include <cinttypes>
+#include <streambuf>
+#include <string>
+
+// Read-only memory-mapped files
+// Files mapped before fork are shared by child processes. Mapping is kept
+// until process exits. Not available on Windows (mapFile returns false).
+bool mapFile(std::string);
+bool findMappedFile(std::string, const char *&, uint64_t &);
+
+// Input stream buffer over memory region
+class MemoryBuffer : public std::streambuf {
+ protected:
+  pos_type seekoff(off_type, std::ios_base::seekdir,
+                   std::ios_base::openmode) override;
+  pos_type seekpos(pos_type, std::ios_base::openmode) override;
+
+ public:
+  void open(const char *, uint64_t);
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/pipe.hh"
+
+#include <cerrno>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#include "simplessd/sim/trace.hh"
+
+#ifndef _MSC_VER
+
+void writeAll(int fd, const void *buffer, size_t length) {
+  const uint8_t *ptr = (const uint8_t *)buffer;
+
+  while (length > 0) {
+    ssize_t ret = write(fd, ptr, length);
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      SimpleSSD::panic("Failed to write to pipe");
+    }
+
+    ptr += ret;
+    length -= (size_t)ret;
+  }
+}
+
+void readAll(int fd, void *buffer, size_t length) {
+  if (!tryReadAll(fd, buffer, length)) {
+    SimpleSSD::panic("Pipe closed unexpectedly");
+  }
+}
+
+bool tryReadAll(int fd, void *buffer, size_t length) {
+  uint8_t *ptr = (uint8_t *)buffer;
+  bool first = true;
+
+  while (length > 0) {
+    ssize_t ret = read(fd, ptr, length);
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      SimpleSSD::panic("Failed to read from pipe");
+    }
+    else if (ret == 0) {
+      if (first) {
+        return false;
+      }
+
+      SimpleSSD::panic("Pipe closed unexpectedly");
+    }
+
+    ptr += ret;
+    length -= (size_t)ret;
+    first = false;
+  }
+
+  return true;
+}
+
+void writeString(int fd, const std::string &str) {
+  uint64_t length = str.length();
+
+  writeAll(fd, &length, sizeof(length));
+  writeAll(fd, str.data(), length);
+}
+
+std::string readString(int fd) {
+  uint64_t length;
+  std::string str;
+
+  readAll(fd, &length, sizeof(length));
+  str.resize(length);
+
+  if (length > 0) {
+    readAll(fd, &str[0], length);
+  }
+
+  return str;
+}
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef __UTIL_PIPE__
+#define __UTIL_PIPE__
+
+#include <cinttypes>
+#include <string>
+
+// Blocking I/O on pipe between simulation processes
+// Panic on error or unexpected end of pipe. Not available on Windows.
+void writeAll(int, const void *, size_t);
+void readAll(int, void *, size_t);
+bool tryReadAll(int, void *, size_t);  // False when pipe is already closed
+void writeString(int, const std::string &);
+std::string readString(int);
+
+#endif